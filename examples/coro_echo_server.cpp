@@ -1,4 +1,3 @@
-#include <array>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -13,17 +12,33 @@ namespace program {
 using namespace ark;
 namespace tcp = net::tcp;
 
+// once every buffer of the ring is held by connections in the middle of an
+// echo, the read is done into a buffer of the connection instead
+task<result<size_t>> echo_unpooled(tcp::socket &s) {
+  char buf[1024];
+  size_t sz =
+      CoTryX(co_await coro::read(s, buffer(buf), transfer_at_least(1)));
+  if (sz != 0)
+    CoTryX(co_await coro::write(s, buffer(buf, sz)));
+  co_return sz;
+}
+
+// the buffers are taken from the provided buffer ring only once data arrives,
+// so idle connections hold none
 task<result<void>> handle_conn(tcp::socket s) {
   for (;;) {
-    std::array<char, 1024> buf;
-
-    size_t sz =
-        CoTryX(co_await coro::read(s, buffer(buf), transfer_at_least(1)));
-
-    if (sz == 0)
+    auto ret = co_await coro::read_some(s);
+    if (ret.has_error() && ret.error().value() == ENOBUFS) {
+      if (CoTryX(co_await echo_unpooled(s)) == 0)
+        break;
+      continue;
+    }
+    leased_buffer buf = CoTryX(std::move(ret));
+
+    if (buf.size() == 0)
       break;
 
-    CoTryX(co_await coro::write(s, buffer(buf, sz)));
+    CoTryX(co_await coro::write(s, buf.buffer()));
   }
   co_return success();
 }
@@ -64,8 +79,12 @@ task<result<void>> echo_srv(tcp::acceptor &ac) {
 }
 
 result<void> run() {
+  async_context_options opts;
+  opts.provided_buffers = 256;
+  opts.provided_buffer_size = 1024;
+
   async_context ctx;
-  TryX(ctx.init());
+  TryX(ctx.init(opts));
 
   net::inet_address ep;
   TryX(ep.host("127.0.0.1"));
@@ -0,0 +1,202 @@
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ark.hpp>
+
+namespace program {
+
+using namespace ark;
+namespace tcp = net::tcp;
+using std::chrono::steady_clock;
+
+struct options {
+  bool fixed = true;
+  size_t block_size = 64 * 1024;
+  int conns = 16;
+  int seconds = 5;
+};
+
+options opts;
+// the file is read and written in place, so it stays in the page cache
+const size_t file_size = 64 * 1024 * 1024;
+std::atomic<long> transferred{0};
+std::atomic<int> running{0};
+
+// either from the registered buffer pool, or plain heap memory
+struct block {
+  optional<registered_buffer> fixed_;
+  std::vector<char> plain_;
+
+  mutable_buffer buf() {
+    if (fixed_)
+      return fixed_->buffer();
+    return buffer(plain_);
+  }
+};
+
+result<block> make_block(async_context &ctx) {
+  block ret;
+  if (opts.fixed)
+    ret.fixed_.emplace(TryX(registered_buffer::create(ctx)));
+  else
+    ret.plain_.resize(opts.block_size);
+  return ret;
+}
+
+task<result<void>> file_worker(async_context &ctx, normal_file &f,
+                               steady_clock::time_point until) {
+  auto b = CoTryX(make_block(ctx));
+  while (steady_clock::now() < until) {
+    if (f.offset() + b.buf().size() > file_size)
+      f.seek(0);
+    auto off = f.offset();
+    CoTryX(co_await coro::write(f, b.buf()));
+    f.seek(off);
+    CoTryX(co_await coro::read(f, b.buf()));
+    transferred += 2 * b.buf().size();
+  }
+  co_return success();
+}
+
+task<result<void>> echo_conn(async_context &ctx, tcp::socket s) {
+  auto b = CoTryX(make_block(ctx));
+  for (;;) {
+    size_t sz = CoTryX(co_await coro::read(s, b.buf()));
+    if (sz == 0)
+      break;
+    CoTryX(co_await coro::write(s, buffer(b.buf(), sz)));
+  }
+  co_return success();
+}
+
+task<void> run_echo_conn(async_context &ctx, tcp::socket s) {
+  auto ret = co_await echo_conn(ctx, std::move(s));
+  if (ret.has_error())
+    std::cerr << "echo : " << ret.error().message() << std::endl;
+}
+
+task<result<void>> echo_srv(async_context &ctx, tcp::acceptor &ac) {
+  for (;;) {
+    tcp::socket s = CoTryX(co_await tcp::coro::accept(ac));
+    co_async(run_echo_conn(ctx, std::move(s)));
+  }
+}
+
+task<result<void>> client(async_context &ctx, const net::address &ep,
+                          steady_clock::time_point until) {
+  auto s = CoTryX(tcp::socket::create(ctx));
+  CoTryX(co_await tcp::coro::connect(s, ep));
+  auto b = CoTryX(make_block(ctx));
+  while (steady_clock::now() < until) {
+    CoTryX(co_await coro::write(s, b.buf()));
+    CoTryX(co_await coro::read(s, b.buf()));
+    transferred += 2 * b.buf().size();
+  }
+  co_return success();
+}
+
+template <class Task> task<void> run_worker(async_context &ctx, Task t) {
+  auto ret = co_await std::move(t);
+  if (ret.has_error())
+    std::cerr << "worker : " << ret.error().message() << std::endl;
+  if (--running == 0)
+    ctx.exit();
+}
+
+void report(const char *what) {
+  std::cout << what << (opts.fixed ? " fixed" : " iovec")
+            << " block_size=" << opts.block_size << " MiB/s="
+            << transferred.load() / opts.seconds / (1024 * 1024) << std::endl;
+  transferred = 0;
+}
+
+async_context_options context_options() {
+  async_context_options ret;
+  ret.registered_buffers = 2 * opts.conns;
+  ret.registered_buffer_size = opts.block_size;
+  return ret;
+}
+
+result<void> bench_file() {
+  async_context ctx;
+  TryX(ctx.init(context_options()));
+
+  std::vector<normal_file> files;
+  for (int i = 0; i < opts.conns; i++) {
+    // filled in by mkostemp, unlinked at once as the fd is kept
+    std::string path = "/tmp/ark_fixed_buffer_bench_XXXXXX";
+    auto f = TryX(normal_file::mkostemp(ctx, path, 0));
+    ::unlink(path.c_str());
+    files.push_back(std::move(f));
+  }
+
+  auto until = steady_clock::now() + std::chrono::seconds(opts.seconds);
+  running = opts.conns;
+  for (auto &f : files)
+    co_async(run_worker(ctx, file_worker(ctx, f, until)));
+  TryX(ctx.run());
+  report("normal_file");
+  return success();
+}
+
+// the server and the clients share a context, so that both sides of each
+// round trip are counted
+result<void> bench_tcp() {
+  async_context ctx;
+  TryX(ctx.init(context_options()));
+
+  net::inet_address ep;
+  TryX(ep.host("127.0.0.1"));
+  ep.port(8083);
+
+  auto ac = TryX(tcp::acceptor::create(ctx));
+  TryX(tcp::bind(ac, ep));
+  TryX(tcp::listen(ac));
+  co_async(echo_srv(ctx, ac));
+
+  auto until = steady_clock::now() + std::chrono::seconds(opts.seconds);
+  running = opts.conns;
+  for (int i = 0; i < opts.conns; i++)
+    co_async(run_worker(ctx, client(ctx, ep.to_address(), until)));
+  TryX(ctx.run());
+  report("tcp::socket");
+  return success();
+}
+
+} // namespace program
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    std::string mode = argv[1];
+    if (mode == "iovec")
+      program::opts.fixed = false;
+    else if (mode != "fixed") {
+      std::cerr << "usage : " << argv[0]
+                << " [fixed|iovec] [block_size] [conns] [seconds]"
+                << std::endl;
+      return 1;
+    }
+  }
+  if (argc > 2)
+    program::opts.block_size = std::strtoul(argv[2], nullptr, 10);
+  if (argc > 3)
+    program::opts.conns = std::atoi(argv[3]);
+  if (argc > 4)
+    program::opts.seconds = std::atoi(argv[4]);
+
+  auto ret = program::bench_file();
+  if (!ret.has_error())
+    ret = program::bench_tcp();
+  if (ret.has_error()) {
+    std::cerr << "error : " << ret.error().message() << std::endl;
+    std::abort();
+  }
+  return 0;
+}
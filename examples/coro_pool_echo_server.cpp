@@ -0,0 +1,83 @@
+#include <array>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ark.hpp>
+
+namespace program {
+
+using namespace ark;
+namespace tcp = net::tcp;
+
+task<result<void>> handle_conn(tcp::socket s) {
+  for (;;) {
+    std::array<char, 1024> buf;
+
+    size_t sz =
+        CoTryX(co_await coro::read(s, buffer(buf), transfer_at_least(1)));
+
+    if (sz == 0)
+      break;
+
+    CoTryX(co_await coro::write(s, buffer(buf, sz)));
+  }
+  co_return success();
+}
+
+task<void> run_handle_conn(tcp::socket s) {
+  auto ret = co_await handle_conn(std::move(s));
+  if (ret.has_error())
+    std::cerr << ret.error().message() << std::endl;
+}
+
+task<result<void>> echo_srv(async_context_pool &pool, tcp::acceptor &ac) {
+  for (;;) {
+    auto ret = co_await tcp::coro::accept(ac);
+    if (ret.has_error()) {
+      pool.stop();
+      co_return ret.as_failure();
+    }
+    co_async(run_handle_conn(std::move(ret.value())));
+  }
+}
+
+result<void> run() {
+  async_context_pool pool;
+  TryX(pool.init());
+
+  net::inet_address ep;
+  TryX(ep.host("127.0.0.1"));
+  ep.port(8080);
+
+  // one acceptor per context, the kernel spreads incoming connections among
+  // them, and accepted sockets stay on the context of their acceptor
+  std::vector<tcp::acceptor> acs;
+  for (size_t i = 0; i < pool.size(); i++) {
+    auto ac = TryX(tcp::acceptor::create(pool.at(i)));
+    TryX(tcp::reuse_port(ac));
+    TryX(tcp::bind(ac, ep));
+    TryX(tcp::listen(ac));
+    acs.emplace_back(std::move(ac));
+  }
+
+  for (auto &ac : acs)
+    co_async(echo_srv(pool, ac));
+
+  TryX(pool.run());
+  TryX(pool.join());
+
+  return success();
+}
+
+} // namespace program
+
+int main(void) {
+  auto ret = program::run();
+  if (ret.has_error()) {
+    std::cerr << "error : " << ret.error().message() << std::endl;
+    std::abort();
+  }
+  return 0;
+}
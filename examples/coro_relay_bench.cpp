@@ -0,0 +1,173 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ark.hpp>
+
+namespace program {
+
+using namespace ark;
+namespace tcp = net::tcp;
+using std::chrono::steady_clock;
+
+struct options {
+  bool splice = true;
+  size_t block_size = 256 * 1024;
+  int conns = 16;
+  int seconds = 5;
+};
+
+options opts;
+std::atomic<long> transferred{0};
+std::atomic<int> clients_running{0};
+net::address sink_ep;
+
+// discards everything received, counting it
+task<result<void>> sink_conn(tcp::socket s) {
+  std::vector<char> buf(opts.block_size);
+  for (;;) {
+    size_t sz =
+        CoTryX(co_await coro::read(s, buffer(buf), transfer_at_least(1)));
+    if (sz == 0)
+      break;
+    transferred += sz;
+  }
+  co_return success();
+}
+
+// the way it is done without splicing, through a buffer in user space
+task<result<void>> copy(tcp::socket &from, tcp::socket &to) {
+  std::vector<char> buf(opts.block_size);
+  for (;;) {
+    size_t sz =
+        CoTryX(co_await coro::read(from, buffer(buf), transfer_at_least(1)));
+    if (sz == 0)
+      break;
+    CoTryX(co_await coro::write(to, buffer(buf.data(), sz)));
+  }
+  co_return success();
+}
+
+// only the client sends, so the other direction only carries the eof of the
+// sink back
+task<result<void>> proxy_conn(tcp::socket s) {
+  auto up = CoTryX(tcp::socket::create(s.context()));
+  CoTryX(co_await tcp::coro::connect(up, sink_ep));
+  if (!opts.splice)
+    co_return co_await copy(s, up);
+  tcp::relay_counters counters;
+  co_return co_await tcp::coro::relay(s, up, counters);
+}
+
+template <class Task> task<void> run_conn(Task t) {
+  auto ret = co_await std::move(t);
+  if (ret.has_error())
+    std::cerr << "conn : " << ret.error().message() << std::endl;
+}
+
+task<result<void>> sink_srv(tcp::acceptor &ac) {
+  for (;;) {
+    tcp::socket s = CoTryX(co_await tcp::coro::accept(ac));
+    co_async(run_conn(sink_conn(std::move(s))));
+  }
+}
+
+task<result<void>> proxy_srv(tcp::acceptor &ac) {
+  for (;;) {
+    tcp::socket s = CoTryX(co_await tcp::coro::accept(ac));
+    co_async(run_conn(proxy_conn(std::move(s))));
+  }
+}
+
+task<result<void>> client(async_context &ctx, const net::address &ep,
+                          steady_clock::time_point until) {
+  auto s = CoTryX(tcp::socket::create(ctx));
+  CoTryX(co_await tcp::coro::connect(s, ep));
+  std::vector<char> buf(opts.block_size, 'x');
+  while (steady_clock::now() < until)
+    CoTryX(co_await coro::write(s, buffer(buf)));
+  co_return success();
+}
+
+task<void> run_client(async_context &ctx, const net::address &ep,
+                      steady_clock::time_point until) {
+  auto ret = co_await client(ctx, ep, until);
+  if (ret.has_error())
+    std::cerr << "client : " << ret.error().message() << std::endl;
+  if (--clients_running == 0)
+    ctx.exit();
+}
+
+result<tcp::acceptor> listen_on(async_context &ctx, net::inet_address &ep,
+                                int port) {
+  TryX(ep.host("127.0.0.1"));
+  ep.port(port);
+  auto ac = TryX(tcp::acceptor::create(ctx));
+  TryX(tcp::bind(ac, ep));
+  TryX(tcp::listen(ac));
+  return ac;
+}
+
+// the sink, the proxy and the clients share a context, so that the cpu time
+// of all of them is counted
+result<void> run() {
+  async_context_options ctx_opts;
+  ctx_opts.pipe_size = opts.block_size;
+
+  async_context ctx;
+  TryX(ctx.init(ctx_opts));
+
+  net::inet_address sink_inet, proxy_inet;
+  auto sink_ac = TryX(listen_on(ctx, sink_inet, 8084));
+  auto proxy_ac = TryX(listen_on(ctx, proxy_inet, 8085));
+  sink_ep = sink_inet.to_address();
+  co_async(sink_srv(sink_ac));
+  co_async(proxy_srv(proxy_ac));
+
+  auto until = steady_clock::now() + std::chrono::seconds(opts.seconds);
+  clients_running = opts.conns;
+  auto proxy_ep = proxy_inet.to_address();
+  for (int i = 0; i < opts.conns; i++)
+    co_async(run_client(ctx, proxy_ep, until));
+  TryX(ctx.run());
+
+  std::cout << (opts.splice ? "splice" : "copy")
+            << " block_size=" << opts.block_size << " conns=" << opts.conns
+            << " MiB/s="
+            << transferred.load() / opts.seconds / (1024 * 1024)
+            << std::endl;
+  return success();
+}
+
+} // namespace program
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    std::string mode = argv[1];
+    if (mode == "copy")
+      program::opts.splice = false;
+    else if (mode != "splice") {
+      std::cerr << "usage : " << argv[0]
+                << " [splice|copy] [block_size] [conns] [seconds]"
+                << std::endl;
+      return 1;
+    }
+  }
+  if (argc > 2)
+    program::opts.block_size = std::strtoul(argv[2], nullptr, 10);
+  if (argc > 3)
+    program::opts.conns = std::atoi(argv[3]);
+  if (argc > 4)
+    program::opts.seconds = std::atoi(argv[4]);
+
+  auto ret = program::run();
+  if (ret.has_error()) {
+    std::cerr << "error : " << ret.error().message() << std::endl;
+    std::abort();
+  }
+  return 0;
+}
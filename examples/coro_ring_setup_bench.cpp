@@ -0,0 +1,183 @@
+#include <sys/resource.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <ark.hpp>
+
+namespace program {
+
+using namespace ark;
+namespace tcp = net::tcp;
+using std::chrono::steady_clock;
+
+struct options {
+  async_setup_policy setup = async_setup_policy::basic;
+  int conns = 64;
+  int seconds = 5;
+};
+
+options opts;
+std::atomic<long> round_trips{0};
+std::atomic<int> clients_running{0};
+
+// sum of the function call and rescheduling interrupts of all the cpus, which
+// are the IPIs sent to interrupt a running thread. x86 only, 0 elsewhere
+long read_ipis() {
+  std::ifstream f{"/proc/interrupts"};
+  std::string line;
+  long sum = 0;
+  while (std::getline(f, line)) {
+    std::istringstream ss{line};
+    std::string name;
+    ss >> name;
+    if (name != "CAL:" && name != "RES:")
+      continue;
+    long n;
+    while (ss >> n)
+      sum += n;
+  }
+  return sum;
+}
+
+long read_context_switches() {
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) == -1)
+    return 0;
+  return ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+task<result<void>> handle_conn(tcp::socket s) {
+  for (;;) {
+    std::array<char, 64> buf;
+
+    size_t sz =
+        CoTryX(co_await coro::read(s, buffer(buf), transfer_at_least(1)));
+
+    if (sz == 0)
+      break;
+
+    CoTryX(co_await coro::write(s, buffer(buf, sz)));
+  }
+  co_return success();
+}
+
+task<void> run_handle_conn(tcp::socket s) {
+  auto ret = co_await handle_conn(std::move(s));
+  if (ret.has_error())
+    std::cerr << ret.error().message() << std::endl;
+}
+
+task<result<void>> echo_srv(tcp::acceptor &ac) {
+  for (;;) {
+    tcp::socket s = CoTryX(co_await tcp::coro::accept(ac));
+    co_async(run_handle_conn(std::move(s)));
+  }
+}
+
+task<result<void>> client(async_context &ctx, const net::address &ep,
+                          steady_clock::time_point until) {
+  auto s = CoTryX(tcp::socket::create(ctx));
+  CoTryX(co_await tcp::coro::connect(s, ep));
+  std::array<char, 64> buf{};
+  while (steady_clock::now() < until) {
+    CoTryX(co_await coro::write(s, buffer(buf)));
+    CoTryX(co_await coro::read(s, buffer(buf)));
+    round_trips++;
+  }
+  co_return success();
+}
+
+task<void> run_client(async_context &ctx, net::address ep,
+                      steady_clock::time_point until) {
+  auto ret = co_await client(ctx, ep, until);
+  if (ret.has_error())
+    std::cerr << "client : " << ret.error().message() << std::endl;
+  if (--clients_running == 0)
+    ctx.exit();
+}
+
+// the server and the clients run on different threads, so that completions
+// of one side are mostly triggered by the other, on another cpu
+result<void> run() {
+  async_context_options ctx_opts;
+  ctx_opts.setup = opts.setup;
+
+  async_context srv_ctx;
+  TryX(srv_ctx.init(ctx_opts));
+  async_context client_ctx;
+  TryX(client_ctx.init(ctx_opts));
+
+  net::inet_address ep;
+  TryX(ep.host("127.0.0.1"));
+  ep.port(8082);
+
+  auto ac = TryX(tcp::acceptor::create(srv_ctx));
+  TryX(tcp::bind(ac, ep));
+  TryX(tcp::listen(ac));
+
+  co_async(echo_srv(ac));
+  result<void> srv_ret = success();
+  std::thread srv_thread{[&srv_ctx, &srv_ret]() { srv_ret = srv_ctx.run(); }};
+
+  long ipis_before = read_ipis();
+  long csw_before = read_context_switches();
+
+  auto until = steady_clock::now() + std::chrono::seconds(opts.seconds);
+  clients_running = opts.conns;
+  for (int i = 0; i < opts.conns; i++)
+    co_async(run_client(client_ctx, ep.to_address(), until));
+  auto client_ret = client_ctx.run();
+
+  long ipis = read_ipis() - ipis_before;
+  long csw = read_context_switches() - csw_before;
+
+  srv_ctx.exit();
+  srv_thread.join();
+  TryX(client_ret);
+  TryX(srv_ret);
+
+  std::cout << "setup_flags=0x" << std::hex << client_ctx.setup_flags()
+            << std::dec << " conns=" << opts.conns
+            << " round_trips/s=" << round_trips.load() / opts.seconds
+            << " ipis/s=" << ipis / opts.seconds
+            << " context_switches/s=" << csw / opts.seconds << std::endl;
+  return success();
+}
+
+} // namespace program
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    std::string setup = argv[1];
+    if (setup == "cooperative")
+      program::opts.setup = ark::async_setup_policy::cooperative;
+    else if (setup == "single_issuer")
+      program::opts.setup = ark::async_setup_policy::single_issuer;
+    else if (setup != "basic") {
+      std::cerr << "usage : " << argv[0]
+                << " [basic|cooperative|single_issuer] [conns] [seconds]"
+                << std::endl;
+      return 1;
+    }
+  }
+  if (argc > 2)
+    program::opts.conns = std::atoi(argv[2]);
+  if (argc > 3)
+    program::opts.seconds = std::atoi(argv[3]);
+
+  auto ret = program::run();
+  if (ret.has_error()) {
+    std::cerr << "error : " << ret.error().message() << std::endl;
+    std::abort();
+  }
+  return 0;
+}
@@ -0,0 +1,149 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <ark.hpp>
+
+namespace program {
+
+using namespace ark;
+namespace tcp = net::tcp;
+using std::chrono::steady_clock;
+
+struct options {
+  bool steal = true;
+  int conns = 16;
+  int work_us = 50;
+  int seconds = 5;
+};
+
+options opts;
+std::atomic<long> round_trips{0};
+std::atomic<int> clients_running{0};
+
+// simulates the cpu time spent on handling a request
+void busy_work() {
+  auto until = steady_clock::now() + std::chrono::microseconds(opts.work_us);
+  while (steady_clock::now() < until) {
+  }
+}
+
+task<result<void>> handle_conn(tcp::socket s) {
+  for (;;) {
+    std::array<char, 64> buf;
+
+    size_t sz =
+        CoTryX(co_await coro::read(s, buffer(buf), transfer_at_least(1)));
+
+    if (sz == 0)
+      break;
+
+    busy_work();
+
+    CoTryX(co_await coro::write(s, buffer(buf, sz)));
+  }
+  co_return success();
+}
+
+task<void> run_handle_conn(tcp::socket s) {
+  auto ret = co_await handle_conn(std::move(s));
+  if (ret.has_error())
+    std::cerr << ret.error().message() << std::endl;
+}
+
+// all the connections are accepted from, and stay bound to, the first context
+// of the pool, which is the worst skew possible
+task<result<void>> echo_srv(work_stealing_scheduler *sched,
+                            tcp::acceptor &ac) {
+  for (;;) {
+    tcp::socket s = CoTryX(co_await tcp::coro::accept(ac));
+    if (sched != nullptr)
+      sched->spawn(run_handle_conn(std::move(s)));
+    else
+      co_async(run_handle_conn(std::move(s)));
+  }
+}
+
+task<result<void>> client(async_context &ctx, const net::address &ep,
+                          steady_clock::time_point until) {
+  auto s = CoTryX(tcp::socket::create(ctx));
+  CoTryX(co_await tcp::coro::connect(s, ep));
+  std::array<char, 64> buf{};
+  while (steady_clock::now() < until) {
+    CoTryX(co_await coro::write(s, buffer(buf)));
+    CoTryX(co_await coro::read(s, buffer(buf)));
+    round_trips++;
+  }
+  co_return success();
+}
+
+task<void> run_client(async_context &ctx, net::address ep,
+                      steady_clock::time_point until) {
+  auto ret = co_await client(ctx, ep, until);
+  if (ret.has_error())
+    std::cerr << "client : " << ret.error().message() << std::endl;
+  if (--clients_running == 0)
+    ctx.exit();
+}
+
+result<void> run() {
+  async_context_pool pool;
+  TryX(pool.init());
+  work_stealing_scheduler sched{pool};
+  if (opts.steal)
+    sched.init();
+
+  net::inet_address ep;
+  TryX(ep.host("127.0.0.1"));
+  ep.port(8081);
+
+  auto ac = TryX(tcp::acceptor::create(pool.at(0)));
+  TryX(tcp::bind(ac, ep));
+  TryX(tcp::listen(ac));
+  async_context client_ctx;
+  TryX(client_ctx.init());
+
+  co_async(echo_srv(opts.steal ? &sched : nullptr, ac));
+  TryX(pool.run());
+
+  auto until = steady_clock::now() + std::chrono::seconds(opts.seconds);
+  clients_running = opts.conns;
+  for (int i = 0; i < opts.conns; i++)
+    co_async(run_client(client_ctx, ep.to_address(), until));
+  auto client_ret = client_ctx.run();
+
+  // the scheduler must outlive the threads of the pool
+  pool.stop();
+  TryX(pool.join());
+  TryX(client_ret);
+
+  std::cout << "steal=" << opts.steal << " threads=" << pool.size()
+            << " conns=" << opts.conns << " work_us=" << opts.work_us
+            << " round_trips/s=" << round_trips.load() / opts.seconds
+            << std::endl;
+  return success();
+}
+
+} // namespace program
+
+int main(int argc, char **argv) {
+  if (argc > 1)
+    program::opts.steal = std::atoi(argv[1]) != 0;
+  if (argc > 2)
+    program::opts.conns = std::atoi(argv[2]);
+  if (argc > 3)
+    program::opts.work_us = std::atoi(argv[3]);
+  if (argc > 4)
+    program::opts.seconds = std::atoi(argv[4]);
+
+  auto ret = program::run();
+  if (ret.has_error()) {
+    std::cerr << "error : " << ret.error().message() << std::endl;
+    std::abort();
+  }
+  return 0;
+}
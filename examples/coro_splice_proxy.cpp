@@ -0,0 +1,86 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <ark.hpp>
+
+namespace program {
+
+using namespace ark;
+namespace tcp = net::tcp;
+
+net::address upstream;
+
+// the bytes never leave the kernel, each direction is spliced through a pipe
+// of the context
+task<result<void>> handle_conn(tcp::socket s) {
+  auto up = CoTryX(tcp::socket::create(s.context()));
+  CoTryX(co_await tcp::coro::connect(up, upstream));
+
+  tcp::relay_counters counters;
+  auto ret = co_await tcp::coro::relay(s, up, counters);
+  std::cout << "relayed " << counters.a_to_b << " bytes upstream, "
+            << counters.b_to_a << " bytes downstream" << std::endl;
+  co_return ret;
+}
+
+task<void> run_handle_conn(tcp::socket s) {
+  auto ret = co_await handle_conn(std::move(s));
+  if (ret.has_error())
+    std::cerr << ret.error().message() << std::endl;
+}
+
+task<result<void>> proxy_srv(tcp::acceptor &ac) {
+  context_exit_guard g_(ac.context());
+
+  for (;;) {
+    tcp::socket s = CoTryX(co_await tcp::coro::accept(ac));
+    co_async(run_handle_conn(std::move(s)));
+  }
+}
+
+result<void> run(int listen_port, const std::string &up_host, int up_port) {
+  async_context ctx;
+  TryX(ctx.init());
+
+  net::inet_address up_ep;
+  TryX(up_ep.host(up_host));
+  up_ep.port(up_port);
+  upstream = up_ep.to_address();
+
+  net::inet_address ep;
+  TryX(ep.host("127.0.0.1"));
+  ep.port(listen_port);
+
+  auto ac = TryX(tcp::acceptor::create(ctx));
+  TryX(tcp::bind(ac, ep));
+  TryX(tcp::listen(ac));
+
+  auto fut = co_async(proxy_srv(ac));
+  TryX(ctx.run());
+  TryX(fut.get());
+
+  return success();
+}
+
+} // namespace program
+
+int main(int argc, char **argv) {
+  int listen_port = 8081;
+  std::string up_host = "127.0.0.1";
+  int up_port = 8080;
+  if (argc > 1)
+    listen_port = std::atoi(argv[1]);
+  if (argc > 2)
+    up_host = argv[2];
+  if (argc > 3)
+    up_port = std::atoi(argv[3]);
+
+  auto ret = program::run(listen_port, up_host, up_port);
+  if (ret.has_error()) {
+    std::cerr << "error : " << ret.error().message() << std::endl;
+    std::abort();
+  }
+  return 0;
+}
@@ -10,6 +10,7 @@ namespace ark {} // namespace ark
 #include <ark/general.hpp>
 #include <ark/io.hpp>
 #include <ark/net.hpp>
+#include <ark/timer.hpp>
 #ifndef ARK_NO_COROUTINES
 #include <ark/coroutine.hpp>
 #endif
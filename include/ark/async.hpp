@@ -9,3 +9,5 @@
 #include "ark/async/async_op.hpp"
 #include "ark/async/callback.hpp"
 #include "ark/async/context.hpp"
+#include "ark/async/context_pool.hpp"
+#include "ark/async/deadline.hpp"
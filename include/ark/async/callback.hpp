@@ -40,6 +40,11 @@ template <> struct callback<void> : public unique_function<void()> {
 
 using syscall_callback_t = callback<result<long>>;
 
+// invoked on each completion of a multishot operation, more is false on the
+// last one
+using syscall_multishot_callback_t =
+    unique_function<void(result<long> ret, bool more)>;
+
 /*! \endcond */
 
 /*! @} */
@@ -14,6 +14,199 @@ namespace ark {
 
 #ifdef USING_DOXYGEN
 
+/*!
+ * \brief setup flags the ring of an \ref ::ark::async_context is created with
+ *
+ * Flags not supported by the running kernel are dropped one after another,
+ * newest first, until the ring could be created, see
+ * \ref ::ark::async_context::setup_flags for the ones in effect.
+ */
+enum class async_setup_policy {
+  /*!
+   * \brief no setup flags, works with any kernel supporting io_uring
+   */
+  basic,
+
+  /*!
+   * \brief IORING_SETUP_COOP_TASKRUN, IORING_SETUP_TASKRUN_FLAG and
+   * IORING_SETUP_SUBMIT_ALL
+   *
+   * the kernel no longer interrupts the thread running the context (with an
+   * IPI if it is running on another cpu) to post completions, which are
+   * instead posted on next entering of the kernel. A failing submission does
+   * not stop the ones after it from being submitted. requires kernel >= 5.19
+   * for all of the flags
+   */
+  cooperative,
+
+  /*!
+   * \brief cooperative, plus IORING_SETUP_SINGLE_ISSUER and
+   * IORING_SETUP_DEFER_TASKRUN
+   *
+   * completions are posted only when the context waits for them, in batches,
+   * on the thread running the context. requires kernel >= 6.1 for all of the
+   * flags.
+   *
+   * \pre run() of the context must always be called from the same thread, as
+   * the first thread calling run() becomes the only one allowed to submit to
+   * the ring
+   */
+  single_issuer,
+};
+
+/*!
+ * \brief options for \ref ::ark::async_context::init
+ *
+ * the default constructed options are fine for most of the cases
+ */
+struct async_context_options {
+  /*!
+   * \brief let a kernel thread poll the submission queue
+   *
+   * with IORING_SETUP_SQPOLL, io operations are picked up by a kernel thread
+   * and no syscall is needed for submission, as long as the thread is kept
+   * busy. Once it has been idle for sq_thread_idle, it goes to sleep, and the
+   * next submission wakes it up with a syscall.
+   *
+   * trades a polling kernel thread for lower latency, requires kernel >= 5.11
+   * (or init() fails with EOPNOTSUPP), and CAP_SYS_NICE before 5.13
+   */
+  bool sqpoll{false};
+
+  /*!
+   * \brief milliseconds the sq thread polls before going to sleep
+   *
+   * 0 for the kernel default, only used with sqpoll
+   */
+  unsigned sq_thread_idle{0};
+
+  /*!
+   * \brief the cpu the sq thread is pinned to, -1 for not pinned
+   *
+   * only used with sqpoll
+   */
+  int sq_thread_cpu{-1};
+
+  /*!
+   * \brief number of entries of the submission queue
+   *
+   * clamped to the limit of the kernel. Io operations started while the
+   * submission queue is full are queued in the context, and submitted once
+   * there is room, rather than failing
+   */
+  unsigned entries{1024};
+
+  /*!
+   * \brief number of entries of the completion queue
+   *
+   * 0 for the kernel default, which is twice the entries. Completions which
+   * do not fit into the completion queue are kept by the kernel until there
+   * is room, requires kernel >= 5.5 (or init() fails with EOPNOTSUPP)
+   */
+  unsigned cq_entries{0};
+
+  /*!
+   * \brief max number of completions handled in each loop iteration
+   */
+  unsigned cqe_batch{1024};
+
+  /*!
+   * \brief setup flags the ring is created with
+   *
+   * with sqpoll, only IORING_SETUP_SUBMIT_ALL is used from the policy
+   */
+  async_setup_policy setup{async_setup_policy::basic};
+
+  /*!
+   * \brief granularity of the timer wheel of the context
+   *
+   * see \ref ::ark::wheel_timer, the wheel costs a ring timeout per tick
+   * while any of them is armed
+   */
+  chrono::nanoseconds timer_tick{chrono::milliseconds(100)};
+
+  /*!
+   * \brief size of the registered file table of the context, 0 for none
+   *
+   * Fds registered in the table are referred to by their slot, which saves
+   * the kernel from looking up and referencing the file on each io
+   * operation. Requires kernel >= 5.19 (or init() fails).
+   *
+   * The lower half of the table is left to \ref ::ark::fd::register_file, the
+   * upper half is where sockets accepted by acceptors which opted in are
+   * placed directly by the kernel, see \ref
+   * ::ark::net::tcp::acceptor::set_direct_accept. Such a socket never has a
+   * normal fd, get() returns -1 and the sync io functions could not be used
+   * on it. Before kernel 6.0 the table is not split, and accepted sockets are
+   * always normal.
+   */
+  unsigned fixed_files{0};
+
+  /*!
+   * \brief number of buffers of the registered buffer pool, 0 for none
+   *
+   * The pool is pinned and mapped into the kernel once, on init(), and its
+   * buffers are handed out by \ref ::ark::registered_buffer. Async reads and
+   * writes on a single buffer lying in the pool skip pinning the pages on each
+   * operation. Before kernel 5.12 the pool is charged against RLIMIT_MEMLOCK,
+   * init() fails with ENOMEM if it does not fit.
+   */
+  unsigned registered_buffers{0};
+
+  /*!
+   * \brief size of each buffer of the registered buffer pool
+   *
+   * rounded up to pages, the whole pool must be no more than 1GiB
+   */
+  size_t registered_buffer_size{64 * 1024};
+
+  /*!
+   * \brief number of buffers of the provided buffer ring, 0 for none
+   *
+   * rounded up to a power of 2, at most 32768. The buffers are picked by the
+   * kernel for \ref ::ark::async::read_some once data arrives, rather than
+   * being tied up by each pending read. Requires kernel >= 5.19 (or init()
+   * fails).
+   */
+  unsigned provided_buffers{0};
+
+  /*!
+   * \brief size of each buffer of the provided buffer ring
+   */
+  size_t provided_buffer_size{4096};
+
+  /*!
+   * \brief min size of a write to a tcp socket sent with zero copy, 0 for
+   * never
+   *
+   * such writes are done with IORING_OP_SENDMSG_ZC, the kernel sends right
+   * from the buffers rather than copying them into the socket, and completes
+   * the write only once done with them. Worth it for writes of hundreds of
+   * KiB and more. Requires kernel >= 6.1, writes with a deadline never use it,
+   * and zero copy is turned off for good if the kernel turns it down.
+   */
+  size_t zerocopy_threshold{0};
+
+  /*!
+   * \brief max number of idle pipes kept by the context for splicing
+   *
+   * \ref ::ark::async::splice between io objects which are not pipes moves the
+   * bytes through a pipe, taken from the pool of the context, or created if
+   * the pool is empty. Pipes left with bytes in them, e.g. on errors, are
+   * closed rather than kept.
+   */
+  unsigned pipes{16};
+
+  /*!
+   * \brief size of the pipes used for splicing, set with F_SETPIPE_SZ
+   *
+   * the bytes moved by a single splice, above /proc/sys/fs/pipe-max-size
+   * the kernel default size of 64KiB is kept unless privileged, 0 for the
+   * kernel default
+   */
+  size_t pipe_size{256 * 1024};
+};
+
 /*!
  * \brief context for running async functions
  *
@@ -24,6 +217,13 @@ namespace ark {
  * Currently, only single-threaded context run() invocation is supported,
  * however, calling its functions from other thread or submitting io operations
  * is supported.
+ *
+ * Io operations started from the thread running run(), e.g. inside callbacks
+ * or coroutines, are simply queued and submitted on next loop iteration. Only
+ * those started from other threads need to wake the loop up, they are handed
+ * over to the thread running run() to be submitted. Each loop iteration
+ * submits the queued operations and waits for completions with a single
+ * syscall.
  */
 class async_context {
 public:
@@ -38,7 +238,7 @@ public:
   /*!
    * \brief init the context
    */
-  result<void> init() noexcept;
+  result<void> init(const async_context_options &opts = {}) noexcept;
 
   /*!
    * \brief start the event loop
@@ -57,12 +257,32 @@ public:
    * \brief let run() return with given result
    */
   void exit(result<void> ret);
+
+  /*!
+   * \brief returns the IORING_SETUP_* flags the ring was created with
+   *
+   * \pre init() must have succeeded
+   */
+  unsigned setup_flags() const noexcept;
+
+  /*!
+   * \brief number of io operations waiting for completion
+   *
+   * includes the ones used internally by the context. A snapshot only, might
+   * have changed once returned if io operations were started from other
+   * threads. Used as a load metric by \ref ::ark::async_context_pool
+   */
+  size_t pending() noexcept;
 };
 
 #else
 
 using async_context = io_uring_async::singlethread_uring_async_context;
 
+using async_setup_policy = io_uring_async::uring_setup_policy;
+
+using async_context_options = io_uring_async::uring_context_options;
+
 namespace async_syscall = io_uring_async::syscall;
 
 #endif
@@ -97,6 +317,11 @@ protected:
    * get called after that
    */
   void set_async_context(async_context *ctx) noexcept { ctx_ = ctx; }
+
+  /*!
+   * \brief returns true if an async_context has been bound to this object
+   */
+  bool has_async_context() const noexcept { return ctx_ != nullptr; }
 };
 
 /*! @} */
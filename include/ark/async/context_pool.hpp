@@ -0,0 +1,218 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async/context.hpp>
+
+namespace ark {
+
+/*! \addtogroup async
+ *  @{
+ */
+
+/*!
+ * \brief a set of \ref ::ark::async_context, each running on its own thread
+ *
+ * As an async_context could only be run() on a single thread, io objects bound
+ * to it will never be served by more than one core. The pool owns several
+ * contexts (one per core by default), each with its own ring, and runs every
+ * one of them on a dedicated thread, optionally pinned to a cpu.
+ *
+ * Io objects are bound to one of the contexts on construction, just like with
+ * a standalone async_context, e.g. tcp::socket::create(pool.next()). The
+ * callbacks of an io object are always invoked on the thread of the context it
+ * is bound to.
+ *
+ * \code
+ * async_context_pool pool;
+ * TryX(pool.init());
+ * auto f = TryX(normal_file::open(pool.least_loaded(), "a.txt", O_RDONLY));
+ * ...
+ * TryX(pool.run());
+ * ...
+ * pool.stop();
+ * TryX(pool.join());
+ * \endcode
+ */
+class async_context_pool {
+private:
+  vector<async_context> ctxs_;
+  vector<int> cpus_;
+  vector<thread> threads_;
+  vector<error_code> errors_;
+  atomic<size_t> next_{0};
+
+  bool inited_{false};
+
+  static vector<int> allowed_cpus() noexcept {
+    vector<int> ret;
+    clinux::cpu_set_t set;
+    CPU_ZERO(&set);
+    if (clinux::sched_getaffinity(0, sizeof(set), &set) == -1)
+      return ret;
+    for (int i = 0; i < CPU_SETSIZE; i++) {
+      if (CPU_ISSET(i, &set))
+        ret.push_back(i);
+    }
+    return ret;
+  }
+
+  static result<void> pin_to(int cpu) noexcept {
+    clinux::cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (clinux::sched_setaffinity(0, sizeof(set), &set) == -1)
+      return errno_ec();
+    return success();
+  }
+
+  void thread_main(size_t i) noexcept {
+    if (!cpus_.empty()) {
+      auto ret = pin_to(cpus_[i % cpus_.size()]);
+      if (ret.has_error()) {
+        errors_[i] = ret.error();
+        return;
+      }
+    }
+    auto ret = ctxs_[i].run();
+    if (ret.has_error())
+      errors_[i] = ret.error();
+  }
+
+public:
+  /*!
+   * \brief constructor
+   *
+   * the default constructed pool is in an unusable state, you'll have to call
+   * init() before doing anything
+   */
+  async_context_pool() noexcept {}
+
+  /*!
+   * \brief create and init the contexts
+   *
+   * \param[in] n number of contexts, 0 for one per cpu available to the
+   * process
+   * \param[in] pin if set to true, the threads running the contexts are
+   * pinned to the available cpus, one cpu each
+   * \param[in] opts passed to init() of every context
+   */
+  result<void> init(size_t n = 0, bool pin = true,
+                    const async_context_options &opts = {}) noexcept {
+    Expects(!inited_);
+    vector<int> cpus = allowed_cpus();
+    if (n == 0)
+      n = max<size_t>(cpus.size(), 1);
+    if (pin)
+      cpus_ = move(cpus);
+
+    ctxs_.resize(n);
+    for (auto &ctx : ctxs_) {
+      OUTCOME_TRY(ctx.init(opts));
+    }
+    errors_.resize(n);
+    inited_ = true;
+    return success();
+  }
+
+  /*!
+   * \brief number of contexts in the pool
+   */
+  size_t size() const noexcept { return ctxs_.size(); }
+
+  /*!
+   * \brief returns the i-th context
+   */
+  async_context &at(size_t i) noexcept {
+    Expects(inited_ && i < ctxs_.size());
+    return ctxs_[i];
+  }
+
+  /*!
+   * \brief returns the contexts one after another, round-robin
+   *
+   * could be called from any thread
+   */
+  async_context &next() noexcept {
+    Expects(inited_);
+    return ctxs_[next_.fetch_add(1, memory_order_relaxed) % ctxs_.size()];
+  }
+
+  /*!
+   * \brief returns the context with fewest io operations in flight
+   *
+   * could be called from any thread, see \ref ::ark::async_context::pending
+   */
+  async_context &least_loaded() noexcept {
+    Expects(inited_);
+    size_t best = 0;
+    size_t best_pending = numeric_limits<size_t>::max();
+    for (size_t i = 0; i < ctxs_.size(); i++) {
+      size_t p = ctxs_[i].pending();
+      if (p < best_pending) {
+        best = i;
+        best_pending = p;
+      }
+    }
+    return ctxs_[best];
+  }
+
+  /*!
+   * \brief start running every context on its own thread
+   *
+   * returns instantly, the contexts keep running until stop() is called, or
+   * exit() is called on each of them.
+   */
+  result<void> run() noexcept {
+    Expects(inited_ && threads_.empty());
+    threads_.reserve(ctxs_.size());
+    for (size_t i = 0; i < ctxs_.size(); i++) {
+      threads_.emplace_back([this, i]() { thread_main(i); });
+    }
+    return success();
+  }
+
+  /*!
+   * \brief let run() of every context successfully return
+   *
+   * could be called from any thread, including the ones running the contexts
+   */
+  void stop() noexcept {
+    for (auto &ctx : ctxs_)
+      ctx.exit();
+  }
+
+  /*!
+   * \brief wait for all the threads started by run() to finish
+   *
+   * returns the first error returned from run() of the contexts, if any.
+   *
+   * \pre must not be called from the threads running the contexts
+   */
+  result<void> join() noexcept {
+    for (auto &t : threads_)
+      t.join();
+    threads_.clear();
+    for (auto &ec : errors_) {
+      if (ec)
+        return exchange(ec, {});
+    }
+    return success();
+  }
+
+  ~async_context_pool() noexcept {
+    if (!threads_.empty()) {
+      stop();
+      static_cast<void>(join());
+    }
+  }
+
+  async_context_pool(async_context_pool &&) = delete;
+  async_context_pool &operator=(async_context_pool &&) = delete;
+  async_context_pool(const async_context_pool &) = delete;
+  async_context_pool &operator=(const async_context_pool &) = delete;
+};
+
+/*! @} */
+
+} // namespace ark
@@ -0,0 +1,41 @@
+#pragma once
+
+/*! \cond FILE_NOT_DOCUMENTED */
+
+#include <ark/bindings.hpp>
+
+namespace ark {
+
+inline clinux::__kernel_timespec
+to_kernel_timespec(chrono::nanoseconds d) noexcept {
+  auto secs = chrono::duration_cast<chrono::seconds>(d);
+  clinux::__kernel_timespec ts{};
+  ts.tv_sec = secs.count();
+  ts.tv_nsec = (d - secs).count();
+  return ts;
+}
+
+// an absolute deadline of an io operation, enforced by an
+// IORING_OP_LINK_TIMEOUT linked to each sqe of it. steady_clock is
+// CLOCK_MONOTONIC, the same as the one of IORING_TIMEOUT_ABS
+struct op_deadline {
+  chrono::steady_clock::time_point at_;
+  // read by the kernel on submission
+  clinux::__kernel_timespec ts_;
+
+  explicit op_deadline(chrono::steady_clock::time_point at) noexcept
+      : at_(at), ts_(to_kernel_timespec(at.time_since_epoch())) {}
+
+  // the operation is cancelled by its linked timeout, which is told apart
+  // from other cancellations by the clock
+  result<long> translate(result<long> ret) const noexcept {
+    if (ret.has_error() && ret.error().value() == ECANCELED &&
+        chrono::steady_clock::now() >= at_)
+      return as_ec(ETIMEDOUT);
+    return ret;
+  }
+};
+
+} // namespace ark
+
+/*! \endcond */
@@ -10,71 +10,460 @@
 namespace ark {
 namespace io_uring_async {
 namespace syscall {
+
+// prep_sqe linked to an IORING_OP_LINK_TIMEOUT, on expiration of which the
+// operation is cancelled. deadline is an absolute CLOCK_MONOTONIC time read by
+// the kernel on submission, which might be later than return, so it must be
+// kept alive till completion. The cqe of the timeout itself is discarded
+template <class UringContext, class PrepSqeCallable>
+inline result<void>
+add_sqe_with_deadline(UringContext &ctx, const PrepSqeCallable &prep_sqe,
+                      clinux::__kernel_timespec *deadline,
+                      syscall_callback_t &&cb) noexcept {
+  array<typename UringContext::callback_t, 2> callbacks{
+      forward<syscall_callback_t>(cb), nullptr};
+  return ctx.add_sqe_chain(
+      [prep_sqe, deadline](sqe_ref sqe, size_t i) {
+        if (i == 0) {
+          prep_sqe(sqe);
+          sqe.add_flags(IOSQE_IO_LINK);
+          return;
+        }
+        sqe.prep_link_timeout(deadline, IORING_TIMEOUT_ABS);
+      },
+      callbacks);
+}
+
 template <class UringContext>
 inline result<typename UringContext::token_t>
-read(UringContext &ctx, int fd, void *buf, unsigned nbytes,
+read(UringContext &ctx, sqe_file f, void *buf, unsigned nbytes,
      clinux::off_t offset, syscall_callback_t &&cb) noexcept {
   return ctx.add_sqe(
-      [&ctx, fd, buf, nbytes, offset](sqe_ref sqe) {
-        sqe.prep_read(fd, buf, nbytes, offset);
+      [&ctx, f, buf, nbytes, offset](sqe_ref sqe) {
+        sqe.prep_read(f.fd_, buf, nbytes, offset);
+        sqe.add_file_flags(f);
       },
       forward<syscall_callback_t>(cb));
 }
 
 template <class UringContext>
 inline result<typename UringContext::token_t>
-write(UringContext &ctx, int fd, const void *buf, unsigned nbytes,
+write(UringContext &ctx, sqe_file f, const void *buf, unsigned nbytes,
       clinux::off_t offset, syscall_callback_t &&cb) noexcept {
   return ctx.add_sqe(
-      [&ctx, fd, buf, nbytes, offset](sqe_ref sqe) {
-        sqe.prep_write(fd, buf, nbytes, offset);
+      [&ctx, f, buf, nbytes, offset](sqe_ref sqe) {
+        sqe.prep_write(f.fd_, buf, nbytes, offset);
+        sqe.add_file_flags(f);
       },
       forward<syscall_callback_t>(cb));
 }
 
 template <class UringContext>
 inline result<typename UringContext::token_t>
-connect(UringContext &ctx, int fd, const clinux::sockaddr *addr,
+connect(UringContext &ctx, sqe_file f, const clinux::sockaddr *addr,
         clinux::socklen_t addrlen, syscall_callback_t &&cb) noexcept {
-  return ctx.add_sqe([&ctx, fd, addr, addrlen](
-                         sqe_ref sqe) { sqe.prep_connect(fd, addr, addrlen); },
-                     forward<syscall_callback_t>(cb));
+  return ctx.add_sqe(
+      [&ctx, f, addr, addrlen](sqe_ref sqe) {
+        sqe.prep_connect(f.fd_, addr, addrlen);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<void>
+connect(UringContext &ctx, sqe_file f, const clinux::sockaddr *addr,
+        clinux::socklen_t addrlen, clinux::__kernel_timespec *deadline,
+        syscall_callback_t &&cb) noexcept {
+  return add_sqe_with_deadline(
+      ctx,
+      [f, addr, addrlen](sqe_ref sqe) {
+        sqe.prep_connect(f.fd_, addr, addrlen);
+        sqe.add_file_flags(f);
+      },
+      deadline, forward<syscall_callback_t>(cb));
 }
 
+// buf must lie in the registered buffer at buf_index
 template <class UringContext>
 inline result<typename UringContext::token_t>
-readv(UringContext &ctx, int fd, const clinux::iovec *iovecs, unsigned nr_vecs,
-      clinux::off_t offset, syscall_callback_t &&cb) noexcept {
+read_fixed(UringContext &ctx, sqe_file f, void *buf, unsigned nbytes,
+           clinux::off_t offset, int buf_index,
+           syscall_callback_t &&cb) noexcept {
   return ctx.add_sqe(
-      [&ctx, fd, iovecs, nr_vecs, offset](sqe_ref sqe) {
-        sqe.prep_readv(fd, iovecs, nr_vecs, offset);
+      [&ctx, f, buf, nbytes, offset, buf_index](sqe_ref sqe) {
+        sqe.prep_read_fixed(f.fd_, buf, nbytes, offset, buf_index);
+        sqe.add_file_flags(f);
       },
       forward<syscall_callback_t>(cb));
 }
 
+template <class UringContext>
+inline result<void>
+read_fixed(UringContext &ctx, sqe_file f, void *buf, unsigned nbytes,
+           clinux::off_t offset, int buf_index,
+           clinux::__kernel_timespec *deadline,
+           syscall_callback_t &&cb) noexcept {
+  return add_sqe_with_deadline(
+      ctx,
+      [f, buf, nbytes, offset, buf_index](sqe_ref sqe) {
+        sqe.prep_read_fixed(f.fd_, buf, nbytes, offset, buf_index);
+        sqe.add_file_flags(f);
+      },
+      deadline, forward<syscall_callback_t>(cb));
+}
+
+// buf must lie in the registered buffer at buf_index
 template <class UringContext>
 inline result<typename UringContext::token_t>
-writev(UringContext &ctx, int fd, const clinux::iovec *iovecs, unsigned nr_vecs,
-       clinux::off_t offset, syscall_callback_t &&cb) noexcept {
+write_fixed(UringContext &ctx, sqe_file f, const void *buf, unsigned nbytes,
+            clinux::off_t offset, int buf_index,
+            syscall_callback_t &&cb) noexcept {
   return ctx.add_sqe(
-      [&ctx, fd, iovecs, nr_vecs, offset](sqe_ref sqe) {
-        sqe.prep_writev(fd, iovecs, nr_vecs, offset);
+      [&ctx, f, buf, nbytes, offset, buf_index](sqe_ref sqe) {
+        sqe.prep_write_fixed(f.fd_, buf, nbytes, offset, buf_index);
+        sqe.add_file_flags(f);
       },
       forward<syscall_callback_t>(cb));
 }
 
+template <class UringContext>
+inline result<void>
+write_fixed(UringContext &ctx, sqe_file f, const void *buf, unsigned nbytes,
+            clinux::off_t offset, int buf_index,
+            clinux::__kernel_timespec *deadline,
+            syscall_callback_t &&cb) noexcept {
+  return add_sqe_with_deadline(
+      ctx,
+      [f, buf, nbytes, offset, buf_index](sqe_ref sqe) {
+        sqe.prep_write_fixed(f.fd_, buf, nbytes, offset, buf_index);
+        sqe.add_file_flags(f);
+      },
+      deadline, forward<syscall_callback_t>(cb));
+}
+
+// reads into a buffer the kernel picks from the provided buffer group bgid,
+// up to its size, the buffer id is in the flags of the cqe
+template <class UringContext>
+inline result<typename UringContext::token_t>
+read_select(UringContext &ctx, sqe_file f, clinux::off_t offset,
+            unsigned short bgid, syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, f, offset, bgid](sqe_ref sqe) {
+        sqe.prep_read(f.fd_, nullptr, 0, offset);
+        sqe.set_buffer_select(bgid);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+// cb is invoked for each chunk received into a buffer the kernel picks from
+// the provided buffer group bgid, the buffer id is in the flags of the cqe
 template <class UringContext>
 inline result<typename UringContext::token_t>
-accept(UringContext &ctx, int fd, clinux::sockaddr *addr,
+recv_multishot(UringContext &ctx, sqe_file f, unsigned short bgid,
+               syscall_multishot_callback_t &&cb) noexcept {
+  return ctx.add_multishot_sqe(
+      [&ctx, f, bgid](sqe_ref sqe) {
+        sqe.prep_recv_multishot(f.fd_, nullptr, 0, 0);
+        sqe.set_buffer_select(bgid);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_multishot_callback_t>(cb));
+}
+
+// msg, and what it points to, are read by the kernel till completion
+template <class UringContext>
+inline result<typename UringContext::token_t>
+sendmsg(UringContext &ctx, sqe_file f, const clinux::msghdr *msg,
+        unsigned flags, syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, f, msg, flags](sqe_ref sqe) {
+        sqe.prep_sendmsg(f.fd_, msg, flags);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+// msg_namelen, msg_controllen and msg_flags of msg are written on completion
+template <class UringContext>
+inline result<typename UringContext::token_t>
+recvmsg(UringContext &ctx, sqe_file f, clinux::msghdr *msg, unsigned flags,
+        syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, f, msg, flags](sqe_ref sqe) {
+        sqe.prep_recvmsg(f.fd_, msg, flags);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+// cb is invoked with the result, then with the notification if the first cqe
+// had IORING_CQE_F_MORE set, see sqe_ref::prep_sendmsg_zc()
+template <class UringContext>
+inline result<typename UringContext::token_t>
+sendmsg_zc(UringContext &ctx, sqe_file f, const clinux::msghdr *msg,
+           unsigned flags, syscall_multishot_callback_t &&cb) noexcept {
+  return ctx.add_multishot_sqe(
+      [&ctx, f, msg, flags](sqe_ref sqe) {
+        sqe.prep_sendmsg_zc(f.fd_, msg, flags);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_multishot_callback_t>(cb));
+}
+
+// the fixed flag of the file spliced from goes to the splice flags
+inline unsigned splice_flags(sqe_file in) noexcept {
+  return in.fixed_ ? SPLICE_F_FD_IN_FIXED : 0;
+}
+
+// off_in / off_out of -1 for pipes and sockets, flags e.g. SPLICE_F_MORE
+template <class UringContext>
+inline result<typename UringContext::token_t>
+splice(UringContext &ctx, sqe_file in, int64_t off_in, sqe_file out,
+       int64_t off_out, unsigned nbytes, unsigned flags,
+       syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, in, off_in, out, off_out, nbytes, flags](sqe_ref sqe) {
+        sqe.prep_splice(in.fd_, off_in, out.fd_, off_out, nbytes,
+                        flags | splice_flags(in));
+        sqe.add_file_flags(out);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+// splices up to nbytes from in to the write end of a pipe, linked to a splice
+// from its read end to out. Unless the first one moves all of nbytes, the
+// second one completes with ECANCELED, and the bytes are left in the pipe.
+// If drain_nbytes is not 0, a splice of the bytes left in the pipe to out is
+// linked in front of them, and the others complete with ECANCELED unless it
+// moves all of them, in which case cb_drain gets its result. flags_out go to
+// the splices to out
+template <class UringContext>
+inline result<void>
+splice_through(UringContext &ctx, sqe_file in, int64_t off_in, int pipe_wr,
+               int pipe_rd, sqe_file out, int64_t off_out,
+               unsigned drain_nbytes, unsigned nbytes, unsigned flags_out,
+               syscall_callback_t &&cb_drain, syscall_callback_t &&cb_in,
+               syscall_callback_t &&cb_out) noexcept {
+  using callback_t = typename UringContext::callback_t;
+  array<callback_t, 3> callbacks{forward<syscall_callback_t>(cb_drain),
+                                 forward<syscall_callback_t>(cb_in),
+                                 forward<syscall_callback_t>(cb_out)};
+  size_t first = drain_nbytes == 0 ? 1 : 0;
+  // the drained bytes go before those of the pair
+  int64_t off_pair = off_out == -1 ? -1 : off_out + drain_nbytes;
+  return ctx.add_sqe_chain(
+      [in, off_in, pipe_wr, pipe_rd, out, off_out, off_pair, drain_nbytes,
+       nbytes, flags_out, first](sqe_ref sqe, size_t i) {
+        switch (first + i) {
+        case 0:
+          sqe.prep_splice(pipe_rd, -1, out.fd_, off_out, drain_nbytes,
+                          flags_out);
+          sqe.add_file_flags(out);
+          sqe.add_flags(IOSQE_IO_LINK);
+          return;
+        case 1:
+          sqe.prep_splice(in.fd_, off_in, pipe_wr, -1, nbytes,
+                          splice_flags(in));
+          sqe.add_flags(IOSQE_IO_LINK);
+          return;
+        default:
+          sqe.prep_splice(pipe_rd, -1, out.fd_, off_pair, nbytes, flags_out);
+          sqe.add_file_flags(out);
+        }
+      },
+      span<callback_t>(callbacks.data() + first, callbacks.size() - first));
+}
+
+template <class UringContext>
+inline result<typename UringContext::token_t>
+tee(UringContext &ctx, sqe_file in, sqe_file out, unsigned nbytes,
+    syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, in, out, nbytes](sqe_ref sqe) {
+        sqe.prep_tee(in.fd_, out.fd_, nbytes, splice_flags(in));
+        sqe.add_file_flags(out);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<typename UringContext::token_t>
+readv(UringContext &ctx, sqe_file f, const clinux::iovec *iovecs,
+      unsigned nr_vecs, clinux::off_t offset,
+      syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, f, iovecs, nr_vecs, offset](sqe_ref sqe) {
+        sqe.prep_readv(f.fd_, iovecs, nr_vecs, offset);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<void>
+readv(UringContext &ctx, sqe_file f, const clinux::iovec *iovecs,
+      unsigned nr_vecs, clinux::off_t offset,
+      clinux::__kernel_timespec *deadline,
+      syscall_callback_t &&cb) noexcept {
+  return add_sqe_with_deadline(
+      ctx,
+      [f, iovecs, nr_vecs, offset](sqe_ref sqe) {
+        sqe.prep_readv(f.fd_, iovecs, nr_vecs, offset);
+        sqe.add_file_flags(f);
+      },
+      deadline, forward<syscall_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<typename UringContext::token_t>
+writev(UringContext &ctx, sqe_file f, const clinux::iovec *iovecs,
+       unsigned nr_vecs, clinux::off_t offset,
+       syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, f, iovecs, nr_vecs, offset](sqe_ref sqe) {
+        sqe.prep_writev(f.fd_, iovecs, nr_vecs, offset);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<void>
+writev(UringContext &ctx, sqe_file f, const clinux::iovec *iovecs,
+       unsigned nr_vecs, clinux::off_t offset,
+       clinux::__kernel_timespec *deadline,
+       syscall_callback_t &&cb) noexcept {
+  return add_sqe_with_deadline(
+      ctx,
+      [f, iovecs, nr_vecs, offset](sqe_ref sqe) {
+        sqe.prep_writev(f.fd_, iovecs, nr_vecs, offset);
+        sqe.add_file_flags(f);
+      },
+      deadline, forward<syscall_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<typename UringContext::token_t>
+accept(UringContext &ctx, sqe_file f, clinux::sockaddr *addr,
        clinux::socklen_t *addrlen, int flags,
        syscall_callback_t &&cb) noexcept {
   return ctx.add_sqe(
-      [&ctx, fd, addr, addrlen, flags](sqe_ref sqe) {
-        sqe.prep_accept(fd, addr, addrlen, flags);
+      [&ctx, f, addr, addrlen, flags](sqe_ref sqe) {
+        sqe.prep_accept(f.fd_, addr, addrlen, flags);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<void>
+accept(UringContext &ctx, sqe_file f, clinux::sockaddr *addr,
+       clinux::socklen_t *addrlen, int flags,
+       clinux::__kernel_timespec *deadline, syscall_callback_t &&cb) noexcept {
+  return add_sqe_with_deadline(
+      ctx,
+      [f, addr, addrlen, flags](sqe_ref sqe) {
+        sqe.prep_accept(f.fd_, addr, addrlen, flags);
+        sqe.add_file_flags(f);
+      },
+      deadline, forward<syscall_callback_t>(cb));
+}
+
+// the accepted socket is placed at a slot of the registered file table
+// allocated by the kernel, which is the result
+template <class UringContext>
+inline result<typename UringContext::token_t>
+accept_direct(UringContext &ctx, sqe_file f, clinux::sockaddr *addr,
+              clinux::socklen_t *addrlen, int flags,
+              syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, f, addr, addrlen, flags](sqe_ref sqe) {
+        sqe.prep_accept_direct(f.fd_, addr, addrlen, flags,
+                               IORING_FILE_INDEX_ALLOC);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<void>
+accept_direct(UringContext &ctx, sqe_file f, clinux::sockaddr *addr,
+              clinux::socklen_t *addrlen, int flags,
+              clinux::__kernel_timespec *deadline,
+              syscall_callback_t &&cb) noexcept {
+  return add_sqe_with_deadline(
+      ctx,
+      [f, addr, addrlen, flags](sqe_ref sqe) {
+        sqe.prep_accept_direct(f.fd_, addr, addrlen, flags,
+                               IORING_FILE_INDEX_ALLOC);
+        sqe.add_file_flags(f);
+      },
+      deadline, forward<syscall_callback_t>(cb));
+}
+
+// cb is invoked for each accepted socket, with the fildes, or the slot of the
+// registered file table if direct
+template <class UringContext>
+inline result<typename UringContext::token_t>
+accept_multishot(UringContext &ctx, sqe_file f, int flags, bool direct,
+                 syscall_multishot_callback_t &&cb) noexcept {
+  return ctx.add_multishot_sqe(
+      [&ctx, f, flags, direct](sqe_ref sqe) {
+        if (direct)
+          sqe.prep_multishot_accept_direct(f.fd_, nullptr, nullptr, flags);
+        else
+          sqe.prep_multishot_accept(f.fd_, nullptr, nullptr, flags);
+        sqe.add_file_flags(f);
+      },
+      forward<syscall_multishot_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<typename UringContext::token_t>
+shutdown(UringContext &ctx, sqe_file f, int how,
+         syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, f, how](sqe_ref sqe) {
+        sqe.prep_shutdown(f.fd_, how);
+        sqe.add_file_flags(f);
       },
       forward<syscall_callback_t>(cb));
 }
 
+// ts is read by the kernel on submission, which might be later than return,
+// so it must be kept alive till completion
+template <class UringContext>
+inline result<typename UringContext::token_t>
+timeout(UringContext &ctx, clinux::__kernel_timespec *ts, unsigned flags,
+        syscall_callback_t &&cb) noexcept {
+  return ctx.add_sqe(
+      [&ctx, ts, flags](sqe_ref sqe) { sqe.prep_timeout(ts, 0, flags); },
+      forward<syscall_callback_t>(cb));
+}
+
+template <class UringContext>
+inline result<typename UringContext::token_t>
+timeout_multishot(UringContext &ctx, clinux::__kernel_timespec *ts,
+                  unsigned flags, syscall_multishot_callback_t &&cb) noexcept {
+  return ctx.add_multishot_sqe(
+      [&ctx, ts, flags](sqe_ref sqe) { sqe.prep_timeout(ts, 0, flags); },
+      forward<syscall_multishot_callback_t>(cb));
+}
+
+// the removed timeout completes with ECANCELED
+template <class UringContext>
+inline result<void>
+timeout_remove(UringContext &ctx,
+               typename UringContext::token_t tok) noexcept {
+  auto ret = ctx.add_sqe(
+      [&ctx, tok](sqe_ref sqe) { sqe.prep_timeout_remove(tok, 0); });
+  if (ret.has_error())
+    return ret.as_failure();
+  return success();
+}
+
 } // namespace syscall
 } // namespace io_uring_async
 } // namespace ark
@@ -4,52 +4,376 @@
 
 #include <ark/bindings.hpp>
 
+#include <ark/async/deadline.hpp>
 #include <ark/async/io_uring/io_uring.hpp>
+#include <ark/async/io_uring/slot_table.hpp>
+#include <ark/async/io_uring/timer_wheel.hpp>
 
 namespace ark {
 namespace io_uring_async {
 using callback_t = unique_function<void(result<long> ret)>;
 
+enum class uring_setup_policy {
+  // the ring is created with no setup flags
+  basic,
+  // IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG |
+  // IORING_SETUP_SUBMIT_ALL
+  cooperative,
+  // cooperative, plus IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN
+  single_issuer,
+};
+
+struct uring_context_options {
+  // let a kernel thread poll the sq, see IORING_SETUP_SQPOLL
+  bool sqpoll{false};
+  // ms of idleness before the sq thread sleeps, 0 for the kernel default
+  unsigned sq_thread_idle{0};
+  // cpu the sq thread is pinned to, -1 for not pinned
+  int sq_thread_cpu{-1};
+  // size of the sq, clamped to the kernel limit
+  unsigned entries{1024};
+  // size of the cq, 0 for the kernel default (twice the sq)
+  unsigned cq_entries{0};
+  // max number of cqes reaped per loop iteration
+  unsigned cqe_batch{1024};
+  // setup flags the ring is created with, those rejected by the running
+  // kernel are dropped
+  uring_setup_policy setup{uring_setup_policy::basic};
+  // granularity of the timer wheel
+  chrono::nanoseconds timer_tick{chrono::milliseconds(100)};
+  // size of the sparse registered file table, 0 for none
+  unsigned fixed_files{0};
+  // number of buffers of the registered buffer pool, 0 for none
+  unsigned registered_buffers{0};
+  // size of each of them, rounded up to pages
+  size_t registered_buffer_size{64 * 1024};
+  // number of buffers of the provided buffer ring, rounded up to a power of
+  // 2, 0 for none
+  unsigned provided_buffers{0};
+  // size of each of them
+  size_t provided_buffer_size{4096};
+  // writes to stream sockets of at least this many bytes are sent with
+  // IORING_OP_SENDMSG_ZC, 0 for never
+  size_t zerocopy_threshold{0};
+  // max number of idle pipes kept for splicing, created on demand
+  unsigned pipes{16};
+  // size the pipes are grown to with F_SETPIPE_SZ, those over the limit of
+  // the user keep the kernel default, 0 for the kernel default
+  size_t pipe_size{256 * 1024};
+};
+
+// both ends of a pipe, the kernel buffer bytes are spliced through, closed on
+// destruction
+struct kernel_pipe {
+  int rd_{-1};
+  int wr_{-1};
+  // capacity in bytes
+  size_t size_{0};
+
+  kernel_pipe() noexcept = default;
+  kernel_pipe(kernel_pipe &&other) noexcept
+      : rd_(exchange(other.rd_, -1)), wr_(exchange(other.wr_, -1)),
+        size_(other.size_) {}
+  kernel_pipe &operator=(kernel_pipe &&other) noexcept {
+    swap(rd_, other.rd_);
+    swap(wr_, other.wr_);
+    swap(size_, other.size_);
+    return *this;
+  }
+
+  ~kernel_pipe() noexcept {
+    if (rd_ != -1)
+      clinux::close(rd_);
+    if (wr_ != -1)
+      clinux::close(wr_);
+  }
+
+  static result<kernel_pipe> create(size_t sz) noexcept {
+    int fds[2];
+    if (clinux::pipe2(fds, O_CLOEXEC) == -1)
+      return errno_ec();
+    kernel_pipe ret;
+    ret.rd_ = fds[0];
+    ret.wr_ = fds[1];
+    int got = -1;
+    // EPERM above /proc/sys/fs/pipe-max-size for unprivileged users
+    if (sz != 0)
+      got = clinux::fcntl(
+          ret.wr_, F_SETPIPE_SZ,
+          static_cast<int>(min(sz, size_t{numeric_limits<int>::max()})));
+    if (got == -1)
+      got = clinux::fcntl(ret.wr_, F_GETPIPE_SZ);
+    if (got == -1)
+      return errno_ec();
+    ret.size_ = static_cast<size_t>(got);
+    return move(ret);
+  }
+};
+
 class base_singlethread_uring_async_context {
 public:
-  using token_t = uintptr_t;
   using callback_t = unique_function<void(result<long> ret)>;
+  // invoked for each cqe of a multishot operation, more is false on the last
+  using multishot_callback_t =
+      unique_function<void(result<long> ret, bool more)>;
+  using idle_handler_t = unique_function<bool()>;
+  using timer_entry = timer_wheel::entry;
 
 private:
+  // exactly one of them is set
+  struct slot_callback {
+    callback_t cb_;
+    multishot_callback_t mcb_;
+  };
+
+public:
+  using token_t = slot_table<slot_callback>::token_t;
+
+private:
+  // a reaped cqe, either the callback is moved out of its slot, or the
+  // multishot callback is invoked in place, as the slot stays occupied until
+  // its last cqe got dispatched
+  struct completion {
+    callback_t cb_;
+    multishot_callback_t *p_mcb_;
+    token_t tok_;
+    result<long> ret_;
+    unsigned flags_;
+    bool more_;
+  };
+
+  // an sqe added from outside the loop thread, or one which did not fit into
+  // the sq, prepared by the loop thread on its next iteration. a chain is kept
+  // as a single entry, as its sqes must be consecutive in the sq
+  struct remote_sqe {
+    unique_function<void(sqe_ref, size_t)> prep_;
+    token_t tok_;
+    // tokens of each sqe of a chain, tok_ is the first of them
+    vector<token_t> chain_toks_;
+
+    const token_t *toks() const noexcept {
+      return chain_toks_.empty() ? &tok_ : chain_toks_.data();
+    }
+    size_t size() const noexcept { return max(chain_toks_.size(), size_t{1}); }
+  };
+
   io_uring r_;
-  map<token_t, callback_t> callbacks_;
+  slot_table<slot_callback> callbacks_;
 
+  // protects remote_sqes_, and the sq itself with sqpoll
   mutex m_submission_;
   mutex m_callbacks_;
 
-  token_t callbacks_idx_;
+  // without sqpoll, only the loop thread touches the sq, so that it could be
+  // flushed and waited on in a single io_uring_enter without holding any lock.
+  // also used as the overflow queue when the sq is full, in which case every
+  // new sqe goes here too, keeping them in order
+  vector<remote_sqe> remote_sqes_;
 
-  static const constexpr unsigned batch_size = 1024;
+  // completed callbacks of a loop iteration, reused to avoid allocating
+  vector<completion> run_callbacks_;
+  unsigned cqe_batch_;
 
   int waker_evfd_;
 
+  // id of the thread currently inside run(), sqes added from that thread will
+  // be submitted at the start of next loop iteration anyway, so the waker is
+  // only needed for other threads
+  atomic<thread::id> loop_thread_{};
+
+  idle_handler_t idle_handler_;
+
+  // driven by a single ring timeout at the next tick, armed only while the
+  // wheel is not empty. touched by the loop thread only
+  timer_wheel wheel_;
+  chrono::steady_clock::time_point wheel_epoch_;
+  chrono::nanoseconds wheel_tick_;
+  clinux::__kernel_timespec wheel_ts_{};
+  bool wheel_armed_{false};
+
+  // the registered file table is split in two, the lower user_files_ slots
+  // are handed out from free_files_ for registering existing fildes, the rest
+  // are allocated by the kernel for direct accepts
+  mutex m_files_;
+  vector<unsigned> free_files_;
+  unsigned user_files_{0};
+  bool direct_accept_{false};
+
+  // anonymous memory of the registered buffer pool
+  struct mapping {
+    void *p_{nullptr};
+    size_t sz_{0};
+
+    ~mapping() noexcept {
+      if (p_ != nullptr)
+        clinux::munmap(p_, sz_);
+    }
+  };
+
+  // the pool is registered as a single buffer at index 0, and handed out in
+  // pieces of buffer_size_, so that any range inside it could be used with
+  // READ_FIXED / WRITE_FIXED
+  mapping buffers_;
+  size_t buffer_size_{0};
+  mutex m_buffers_;
+  vector<unsigned> free_buffers_;
+
+  // freed before the ring is, thus declared after it
+  struct buf_ring {
+    io_uring *r_{nullptr};
+    liburing::io_uring_buf_ring *br_{nullptr};
+    unsigned nr_{0};
+
+    ~buf_ring() noexcept {
+      if (br_ != nullptr)
+        r_->free_buf_ring(br_, nr_, provided_buffer_group);
+    }
+  };
+
+  // the buffers of provided_buffer_group, picked by the kernel for operations
+  // with IOSQE_BUFFER_SELECT, and given back by recycle_buffer()
+  mapping pbufs_;
+  buf_ring pbuf_ring_;
+  size_t pbuf_size_{0};
+  mutex m_pbufs_;
+
+  // idle empty pipes for splicing, at most max_free_pipes_ of them
+  mutex m_pipes_;
+  vector<kernel_pipe> free_pipes_;
+  unsigned max_free_pipes_{0};
+  size_t pipe_size_{0};
+
+  // flags of the cqe whose callback is being invoked
+  unsigned cqe_flags_{0};
+
+  size_t zerocopy_threshold_{0};
+  // cleared once the kernel turned down a zero copy send
+  atomic<bool> zerocopy_supported_{true};
+
   bool inited_;
-  bool exiting_;
+  bool sqpoll_{false};
+  bool defer_taskrun_{false};
+  bool rings_enabled_{true};
+  atomic<bool> exiting_;
   error_code exiting_error_;
 
-  template <typename PrepSqeCallable // void prep_sqe(sqe_ref) noexcept
+  // either all of the n sqes are written, consecutively, or none of them
+  template <typename PrepSqesCallable // void prep_sqes(sqe_ref, size_t i)
+                                      // noexcept
             >
-  result<token_t> base_add_sqe(const PrepSqeCallable &prep_sqe) noexcept {
-    OUTCOME_TRY(sqe, r_.get_sqe());
-    prep_sqe(sqe);
-    token_t tok = callbacks_idx_;
-    sqe.set_data(reinterpret_cast<void *>(callbacks_idx_++));
+  result<void> prep_sqes_now(PrepSqesCallable &prep_sqes, const token_t *toks,
+                             size_t n) noexcept {
+    if (r_.sq_space_left() < n)
+      return as_ec(ENOBUFS);
+    for (size_t i = 0; i < n; i++) {
+      sqe_ref sqe = r_.get_sqe().value();
+      prep_sqes(sqe, i);
+      sqe.set_data64(toks[i]);
 #ifdef ARK_ADVANCED_DEBUG_VERBOSITY
-    sqe.dump();
+      sqe.dump();
 #endif
+    }
+    return success();
+  }
+
+  // if the sq is full, submit what is in it to make room and try again
+  template <typename PrepSqesCallable // void prep_sqes(sqe_ref, size_t i)
+                                      // noexcept
+            >
+  result<void> prep_sqes_or_flush(PrepSqesCallable &prep_sqes,
+                                  const token_t *toks, size_t n) noexcept {
+    auto ret = prep_sqes_now(prep_sqes, toks, n);
+    if (!ret.has_error())
+      return ret;
+    r_.submit();
+    return prep_sqes_now(prep_sqes, toks, n);
+  }
+
+  void forget(const token_t *toks, size_t n) noexcept {
+    for (size_t i = 0; i < n; i++)
+      forget(toks[i]);
+  }
+
+  // the slots of toks must have been occupied (or be null_token), m_submission_
+  // must be held and m_callbacks_ must not be held, the slots are released on
+  // failure
+  template <typename PrepSqesCallable // void prep_sqes(sqe_ref, size_t i)
+                                      // noexcept
+            >
+  result<void> base_add_sqes(const PrepSqesCallable &prep_sqes,
+                             const token_t *toks, size_t n) noexcept {
+    // could never fit into the sq
+    if (n > r_.sq_entries()) {
+      forget(toks, n);
+      return as_ec(EINVAL);
+    }
+    bool loop_thread = in_loop_thread();
+    if ((sqpoll_ || loop_thread) && remote_sqes_.empty()) {
+      auto ret = prep_sqes_or_flush(prep_sqes, toks, n);
+      if (!ret.has_error()) {
+        // the sq thread picks the sqes up as soon as they are published,
+        // which costs no syscall unless the sq thread needs a wakeup
+        if (sqpoll_)
+          r_.submit();
+        return success();
+      }
+    }
+    remote_sqes_.push_back({PrepSqesCallable{prep_sqes}, toks[0], {}});
+    if (n > 1)
+      remote_sqes_.back().chain_toks_.assign(toks, toks + n);
+    if (loop_thread)
+      return success();
     auto ret = wake();
     if (ret.has_error()) {
-      cancel(tok);
+      remote_sqes_.pop_back();
+      forget(toks, n);
       return ret.as_failure();
     }
+    return success();
+  }
+
+  template <typename PrepSqeCallable // void prep_sqe(sqe_ref) noexcept
+            >
+  result<token_t> base_add_sqe(const PrepSqeCallable &prep_sqe,
+                               token_t tok) noexcept {
+    OUTCOME_TRY(base_add_sqes(
+        [prep_sqe](sqe_ref sqe, size_t) { prep_sqe(sqe); }, &tok, 1));
     return tok;
   }
 
+  // called on the loop thread, returns false if some of the sqes are still
+  // waiting for room in the sq
+  bool flush_remote_sqes() noexcept {
+    lock_guard<mutex> g_submission(m_submission_);
+    auto it = remote_sqes_.begin();
+    for (; it != remote_sqes_.end(); ++it) {
+      if (prep_sqes_or_flush(it->prep_, it->toks(), it->size()).has_error())
+        break;
+    }
+    remote_sqes_.erase(remote_sqes_.begin(), it);
+    if (sqpoll_)
+      r_.submit();
+    return remote_sqes_.empty();
+  }
+
+  bool in_loop_thread() const noexcept {
+    return loop_thread_.load(memory_order_relaxed) == this_thread::get_id();
+  }
+
+  // the state only the loop touches, e.g. the timer wheel, is safe to touch
+  // from the loop thread, or from any thread while the loop does not run
+  bool loop_owned() const noexcept {
+    auto id = loop_thread_.load(memory_order_relaxed);
+    return id == thread::id{} || id == this_thread::get_id();
+  }
+
+  void forget(const token_t token) noexcept {
+    if (token == callbacks_.null_token)
+      return;
+    lock_guard<mutex> g_callbacks(m_callbacks_);
+    callbacks_.erase(token);
+  }
+
   result<void> add_waker() noexcept {
     auto ret =
         add_sqe([this](sqe_ref sqe) { sqe.prep_poll_add(waker_evfd_, POLLIN); },
@@ -73,19 +397,222 @@ private:
     return success();
   }
 
-  void submit() noexcept {
-    lock_guard<mutex> g_submission(m_submission_);
-    int s = r_.submit();
+  uint64_t wheel_now() const noexcept {
+    return static_cast<uint64_t>((chrono::steady_clock::now() - wheel_epoch_) /
+                                 wheel_tick_);
+  }
+
+  void arm_wheel() noexcept {
+    auto at = wheel_epoch_ + wheel_tick_ * wheel_.current();
+    wheel_ts_ = to_kernel_timespec(at.time_since_epoch());
+    auto ret = add_sqe(
+        [this](sqe_ref sqe) {
+          sqe.prep_timeout(addressof(wheel_ts_), 0, IORING_TIMEOUT_ABS);
+        },
+        [this](result<long> ret) { on_wheel_tick(); });
+    if (ret.has_error()) {
+      exit(ret.as_failure());
+      return;
+    }
+    wheel_armed_ = true;
+  }
+
+  void on_wheel_tick() noexcept {
+    wheel_armed_ = false;
+    wheel_.advance(wheel_now());
+    if (!wheel_.empty())
+      arm_wheel();
+  }
+
+  result<void> init_files(unsigned nr) noexcept {
+    OUTCOME_TRY(r_.register_files_sparse(nr));
+    user_files_ = nr / 2;
+    // IORING_FILE_INDEX_ALLOC picks from the whole table before 6.0, which
+    // would collide with the slots handed out by us
+    direct_accept_ =
+        !r_.register_file_alloc_range(user_files_, nr - user_files_)
+             .has_error();
+    if (!direct_accept_)
+      user_files_ = nr;
+    lock_guard<mutex> g_files(m_files_);
+    free_files_.reserve(user_files_);
+    // lowest slots first
+    for (unsigned i = user_files_; i > 0; i--)
+      free_files_.push_back(i - 1);
+    return success();
+  }
+
+  void release_file(unsigned slot) noexcept {
+    if (slot >= user_files_)
+      return;
+    lock_guard<mutex> g_files(m_files_);
+    free_files_.push_back(slot);
+  }
+
+  result<void> init_buffers(unsigned nr, size_t sz) noexcept {
+    auto page = static_cast<size_t>(clinux::sysconf(_SC_PAGESIZE));
+    sz = (max(sz, size_t{1}) + page - 1) / page * page;
+    // the kernel limit for a single registered buffer
+    if (sz > (size_t{1} << 30) / nr)
+      return as_ec(EINVAL);
+    void *p = clinux::mmap(nullptr, sz * nr, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+      return errno_ec();
+    buffers_.p_ = p;
+    buffers_.sz_ = sz * nr;
+    clinux::iovec iov{p, sz * nr};
+    OUTCOME_TRY(r_.register_buffers(&iov, 1));
+    buffer_size_ = sz;
+    lock_guard<mutex> g_buffers(m_buffers_);
+    free_buffers_.reserve(nr);
+    for (unsigned i = nr; i > 0; i--)
+      free_buffers_.push_back(i - 1);
+    return success();
+  }
+
+  result<void> init_pbufs(unsigned nr, size_t sz) noexcept {
+    // the kernel limit of a buffer ring
+    if (nr > (1u << 15) || sz == 0 || sz > numeric_limits<unsigned>::max())
+      return as_ec(EINVAL);
+    unsigned nr_pow2 = 1;
+    while (nr_pow2 < nr)
+      nr_pow2 <<= 1;
+    void *p = clinux::mmap(nullptr, sz * nr_pow2, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+      return errno_ec();
+    pbufs_.p_ = p;
+    pbufs_.sz_ = sz * nr_pow2;
+    pbuf_size_ = sz;
+    auto br = r_.setup_buf_ring(nr_pow2, provided_buffer_group);
+    if (br.has_error())
+      return br.as_failure();
+    pbuf_ring_.r_ = &r_;
+    pbuf_ring_.br_ = br.value();
+    pbuf_ring_.nr_ = nr_pow2;
+    auto mask = liburing::io_uring_buf_ring_mask(nr_pow2);
+    for (unsigned i = 0; i < nr_pow2; i++)
+      liburing::io_uring_buf_ring_add(
+          pbuf_ring_.br_, static_cast<char *>(p) + i * sz,
+          static_cast<unsigned>(sz), static_cast<unsigned short>(i), mask,
+          static_cast<int>(i));
+    liburing::io_uring_buf_ring_advance(pbuf_ring_.br_,
+                                        static_cast<int>(nr_pow2));
+    return success();
+  }
+
+  // flags to try for the policy, newest first in fallback_flags
+  static unsigned policy_flags(uring_setup_policy policy) noexcept {
+    unsigned flags = 0;
+    switch (policy) {
+    case uring_setup_policy::single_issuer:
+      flags |= IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN |
+               IORING_SETUP_R_DISABLED;
+      [[fallthrough]];
+    case uring_setup_policy::cooperative:
+      flags |= IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG |
+               IORING_SETUP_SUBMIT_ALL;
+      [[fallthrough]];
+    case uring_setup_policy::basic:
+      break;
+    }
+    return flags;
+  }
+
+  // each step is dropped after the kernel rejected the flags with EINVAL,
+  // ordered by the kernel version that introduced them, newest first
+  static const constexpr array<unsigned, 4> fallback_flags{
+      IORING_SETUP_DEFER_TASKRUN,                            // 6.1
+      IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_R_DISABLED,  // 6.0
+      IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG, // 5.19
+      IORING_SETUP_SUBMIT_ALL,                               // 5.18
+  };
+
+  result<void> init_ring(const uring_context_options &opts) noexcept {
+    unsigned flags = policy_flags(opts.setup) | IORING_SETUP_CLAMP;
+    // the sq thread could not run task work for us, and sqes are submitted
+    // from any thread in that mode
+    if (opts.sqpoll)
+      flags &= IORING_SETUP_SUBMIT_ALL | IORING_SETUP_CLAMP;
+
+    auto make_params = [&opts](unsigned flags) {
+      liburing::io_uring_params params{};
+      params.flags = flags;
+      if (opts.cq_entries != 0) {
+        params.flags |= IORING_SETUP_CQSIZE;
+        params.cq_entries = opts.cq_entries;
+      }
+      if (opts.sqpoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = opts.sq_thread_idle;
+        if (opts.sq_thread_cpu >= 0) {
+          params.flags |= IORING_SETUP_SQ_AFF;
+          params.sq_thread_cpu = static_cast<unsigned>(opts.sq_thread_cpu);
+        }
+      }
+      return params;
+    };
+
+    auto params = make_params(flags);
+    auto ret = r_.queue_init(opts.entries, params);
+    for (unsigned step : fallback_flags) {
+      if (!ret.has_error() || ret.error().value() != EINVAL)
+        break;
+      if ((flags & step) == 0)
+        continue;
+      flags &= ~step;
+      params = make_params(flags);
+      ret = r_.queue_init(opts.entries, params);
+    }
+    if (ret.has_error())
+      return ret.as_failure();
+
+    // without IORING_FEAT_NODROP (5.5), cqes are silently dropped once the cq
+    // overflows, and their callbacks would never get invoked
+    if (!(r_.features() & IORING_FEAT_NODROP))
+      return as_ec(EOPNOTSUPP);
+
+    defer_taskrun_ = (r_.flags() & IORING_SETUP_DEFER_TASKRUN) != 0;
+    rings_enabled_ = (r_.flags() & IORING_SETUP_R_DISABLED) == 0;
+    return success();
+  }
+
+  // submits the sq, and unless nowait, blocks for completions, costing a
+  // single io_uring_enter either way
+  result<void> submit_and_wait(bool nowait, bool backlog) noexcept {
+    if (sqpoll_) {
+      // everything has been submitted by base_add_sqe already
+      if (nowait)
+        return success();
+      // the sq thread is lagging behind, wait for it rather than completions
+      if (backlog)
+        return r_.sqring_wait();
+      return r_.wait();
+    }
+    if (!nowait) {
+      auto ret = r_.submit_and_wait(1);
+      // the overflowed cqes could not be flushed into the cq, which they will
+      // be once we reaped the cq (liburing enters with
+      // IORING_ENTER_GETEVENTS for that on IORING_SQ_CQ_OVERFLOW)
+      if (ret.has_error() && ret.error().value() == EBUSY)
+        return success();
+      return ret;
+    }
+    // with IORING_SETUP_DEFER_TASKRUN, completions only get posted while
+    // entering with IORING_ENTER_GETEVENTS
+    int s = defer_taskrun_ ? r_.submit_and_get_events() : r_.submit();
 #ifdef ARK_ADVANCED_DEBUG_VERBOSITY
     cerr << "### SUBMITTED : " << s << endl;
 #endif
+    return success();
   }
 
 public:
   base_singlethread_uring_async_context() noexcept
-      : inited_(false), exiting_(false), callbacks_idx_(0) {}
+      : inited_(false), exiting_(false) {}
 
-  result<void> init() noexcept {
+  result<void> init(const uring_context_options &opts = {}) noexcept {
     Expects(!inited_);
 
     int waker_ret = clinux::eventfd(0, 0);
@@ -93,9 +620,35 @@ public:
       return errno_ec();
     waker_evfd_ = waker_ret;
 
-    auto ret = r_.queue_init(batch_size, 0);
-    if (ret.has_error())
-      return ret.as_failure();
+    OUTCOME_TRY(init_ring(opts));
+    // before 5.11, the sq thread only accepts registered files
+    if (opts.sqpoll && !(r_.features() & IORING_FEAT_SQPOLL_NONFIXED))
+      return as_ec(EOPNOTSUPP);
+    sqpoll_ = opts.sqpoll;
+    if (opts.fixed_files != 0)
+      OUTCOME_TRY(init_files(opts.fixed_files));
+    if (opts.registered_buffers != 0)
+      OUTCOME_TRY(
+          init_buffers(opts.registered_buffers, opts.registered_buffer_size));
+    if (opts.provided_buffers != 0)
+      OUTCOME_TRY(
+          init_pbufs(opts.provided_buffers, opts.provided_buffer_size));
+
+    {
+      lock_guard<mutex> g_callbacks(m_callbacks_);
+      callbacks_.reserve(opts.entries);
+    }
+    zerocopy_threshold_ = opts.zerocopy_threshold;
+    {
+      lock_guard<mutex> g_pipes(m_pipes_);
+      free_pipes_.reserve(opts.pipes);
+    }
+    max_free_pipes_ = opts.pipes;
+    pipe_size_ = opts.pipe_size;
+    cqe_batch_ = max(opts.cqe_batch, 1u);
+    run_callbacks_.reserve(cqe_batch_);
+    wheel_tick_ = max(opts.timer_tick, chrono::nanoseconds{1});
+    wheel_epoch_ = chrono::steady_clock::now();
 
     inited_ = true;
     return add_waker();
@@ -103,6 +656,8 @@ public:
 
   void exit() noexcept {
     exiting_ = true;
+    if (in_loop_thread())
+      return;
     auto ret = wake();
     if (ret.has_error()) {
       cerr << "error occurred, waking up thread failed : "
@@ -131,7 +686,7 @@ public:
             >
   result<token_t> add_sqe(const PrepSqeCallable &prep_sqe) noexcept {
     lock_guard<mutex> g_submission(m_submission_);
-    return base_add_sqe(prep_sqe);
+    return base_add_sqe(prep_sqe, callbacks_.null_token);
   }
 
   template <typename PrepSqeCallable // void prep_sqe(sqe_ref) noexcept
@@ -139,21 +694,311 @@ public:
   result<token_t> add_sqe(const PrepSqeCallable &prep_sqe,
                           callback_t &&callback) noexcept {
     lock_guard<mutex> g_submission(m_submission_);
-    lock_guard<mutex> g_callbacks(m_callbacks_);
-    OUTCOME_TRY(tok, base_add_sqe(prep_sqe));
-    callbacks_[tok] = forward<callback_t>(callback);
-    return tok;
+    token_t tok;
+    {
+      lock_guard<mutex> g_callbacks(m_callbacks_);
+      tok = callbacks_.emplace({forward<callback_t>(callback), nullptr});
+    }
+    return base_add_sqe(prep_sqe, tok);
+  }
+
+  // for operations posting several cqes flagged with IORING_CQE_F_MORE, the
+  // callback is kept until the last one
+  template <typename PrepSqeCallable // void prep_sqe(sqe_ref) noexcept
+            >
+  result<token_t>
+  add_multishot_sqe(const PrepSqeCallable &prep_sqe,
+                    multishot_callback_t &&callback) noexcept {
+    lock_guard<mutex> g_submission(m_submission_);
+    token_t tok;
+    {
+      lock_guard<mutex> g_callbacks(m_callbacks_);
+      tok = callbacks_.emplace(
+          {nullptr, forward<multishot_callback_t>(callback)});
+    }
+    return base_add_sqe(prep_sqe, tok);
   }
 
-  void cancel(const token_t token) noexcept {
+  // longest chain accepted by add_sqe_chain()
+  static const constexpr size_t max_chain_length = 16;
+
+  // the sqes written by prep_sqes(sqe, i), for each i below callbacks.size(),
+  // are placed consecutively in the sq and submitted together, as required
+  // for sqes linked with IOSQE_IO_LINK or IOSQE_IO_HARDLINK. the cqe of the
+  // i-th sqe goes to callbacks[i], or is discarded if it is empty. the
+  // callbacks are moved from
+  template <typename PrepSqesCallable // void prep_sqes(sqe_ref, size_t i)
+                                      // noexcept
+            >
+  result<void> add_sqe_chain(const PrepSqesCallable &prep_sqes,
+                             span<callback_t> callbacks) noexcept {
+    size_t n = callbacks.size();
+    if (n == 0 || n > max_chain_length)
+      return as_ec(EINVAL);
+    array<token_t, max_chain_length> toks;
+    lock_guard<mutex> g_submission(m_submission_);
+    {
+      lock_guard<mutex> g_callbacks(m_callbacks_);
+      for (size_t i = 0; i < n; i++)
+        toks[i] = callbacks[i]
+                      ? callbacks_.emplace({move(callbacks[i]), nullptr})
+                      : callbacks_.null_token;
+    }
+    return base_add_sqes(prep_sqes, toks.data(), n);
+  }
+
+  // the kernel cancels the operation, its callback is still invoked, with
+  // ECANCELED if it did not complete in the meantime. So the buffers are
+  // never touched by the kernel once the callback is invoked
+  result<void> cancel(const token_t token) noexcept {
+    if (token == callbacks_.null_token)
+      return success();
+    auto ret = add_sqe([token](sqe_ref sqe) { sqe.prep_cancel64(token, 0); });
+    if (ret.has_error())
+      return ret.as_failure();
+    return success();
+  }
+
+  // same as cancel(), for every operation in flight on fd, requires kernel >=
+  // 5.19, or 6.0 for a slot of the registered file table
+  result<void> cancel_fd(sqe_file f) noexcept {
+    auto ret = add_sqe([f](sqe_ref sqe) {
+      sqe.prep_cancel_fd(f.fd_, IORING_ASYNC_CANCEL_ALL |
+                                    (f.fixed_ ? IORING_ASYNC_CANCEL_FD_FIXED
+                                              : 0));
+    });
+    if (ret.has_error())
+      return ret.as_failure();
+    return success();
+  }
+
+  // cancel_fd(), then close fd. The cancellation must be issued before the
+  // fildes could be reused, so unless the sq could be submitted right away,
+  // the fd is closed by an IORING_OP_CLOSE after it, and the error of close
+  // is lost
+  result<void> cancel_and_close(int fd) noexcept {
+    auto prep_cancel = [fd](sqe_ref sqe, size_t) {
+      sqe.prep_cancel_fd(fd, IORING_ASYNC_CANCEL_ALL);
+    };
+    const token_t null_tok = callbacks_.null_token;
+    {
+      lock_guard<mutex> g_submission(m_submission_);
+      bool now = !sqpoll_ && in_loop_thread() && remote_sqes_.empty() &&
+                 !prep_sqes_or_flush(prep_cancel, &null_tok, 1).has_error();
+      if (!now) {
+        OUTCOME_TRY(base_add_sqes(prep_cancel, &null_tok, 1));
+        OUTCOME_TRY(base_add_sqe([fd](sqe_ref sqe) { sqe.prep_close(fd); },
+                                 null_tok));
+        return success();
+      }
+      // the cancellation is issued inline
+      r_.submit();
+    }
+    if (clinux::close(fd) != 0)
+      return errno_ec();
+    return success();
+  }
+
+  // expires after at least d, and at most a tick later, re-arming if already
+  // armed. O(1) and never allocates, must be called from the loop thread, or
+  // before run()
+  void arm_timer(timer_entry &e, chrono::nanoseconds d) noexcept {
+    Expects(loop_owned());
+    // the wheel stops ticking while empty, catch up with the clock
+    if (wheel_.empty() && !wheel_armed_)
+      wheel_.reset(wheel_now() + 1);
+    auto ticks = (d + wheel_tick_ - chrono::nanoseconds{1}) / wheel_tick_;
+    wheel_.arm(e, static_cast<uint64_t>(max(ticks, decltype(ticks){1})));
+    if (!wheel_armed_)
+      arm_wheel();
+  }
+
+  // O(1), the ring timeout is left to expire once more at most
+  void cancel_timer(timer_entry &e) noexcept {
+    Expects(loop_owned());
+    e.cancel();
+  }
+
+  // runs fn right away if loop_owned(), otherwise on the loop thread, from
+  // the completion of a nop. fn is dropped on failure
+  result<void> dispatch(unique_function<void()> &&fn) noexcept {
+    if (loop_owned()) {
+      fn();
+      return success();
+    }
+    auto ret = add_sqe([](sqe_ref sqe) { sqe.prep_nop(); },
+                       [fn = move(fn)](result<long>) mutable { fn(); });
+    if (ret.has_error())
+      return ret.as_failure();
+    return success();
+  }
+
+  // installs fd into a free slot of the registered file table, which holds a
+  // reference to the file of its own. With IORING_SETUP_SINGLE_ISSUER, only
+  // allowed from the thread running the context once it runs
+  result<int> register_file(int fd) noexcept {
+    unsigned slot;
+    {
+      lock_guard<mutex> g_files(m_files_);
+      if (free_files_.empty())
+        return as_ec(ENFILE);
+      slot = free_files_.back();
+      free_files_.pop_back();
+    }
+    auto ret = r_.register_files_update(slot, &fd, 1);
+    if (ret.has_error()) {
+      release_file(slot);
+      return ret.as_failure();
+    }
+    return static_cast<int>(slot);
+  }
+
+  // cancel_fd() on the slot, then empty it, which closes the file unless
+  // referenced elsewhere. The slot is reused once done
+  result<void> close_file(int slot) noexcept {
+    lock_guard<mutex> g_submission(m_submission_);
+    OUTCOME_TRY(base_add_sqe(
+        [slot](sqe_ref sqe) {
+          sqe.prep_cancel_fd(slot, IORING_ASYNC_CANCEL_ALL |
+                                       IORING_ASYNC_CANCEL_FD_FIXED);
+        },
+        callbacks_.null_token));
+    token_t tok;
+    {
+      lock_guard<mutex> g_callbacks(m_callbacks_);
+      tok = callbacks_.emplace(
+          {[this, slot](result<long> ret) {
+             release_file(static_cast<unsigned>(slot));
+           },
+           nullptr});
+    }
+    OUTCOME_TRY(base_add_sqe(
+        [slot](sqe_ref sqe) {
+          sqe.prep_close_direct(static_cast<unsigned>(slot));
+        },
+        tok));
+    return success();
+  }
+
+  // if accepted sockets could be placed into the registered file table
+  bool direct_accept() const noexcept { return direct_accept_; }
+
+  // takes a free buffer from the registered buffer pool, ENOBUFS if none
+  result<clinux::iovec> acquire_buffer() noexcept {
+    lock_guard<mutex> g_buffers(m_buffers_);
+    if (free_buffers_.empty())
+      return as_ec(ENOBUFS);
+    unsigned i = free_buffers_.back();
+    free_buffers_.pop_back();
+    return clinux::iovec{static_cast<char *>(buffers_.p_) + i * buffer_size_,
+                         buffer_size_};
+  }
+
+  // p is the start of a buffer from acquire_buffer()
+  void release_buffer(const void *p) noexcept {
+    auto off = static_cast<const char *>(p) - static_cast<char *>(buffers_.p_);
+    lock_guard<mutex> g_buffers(m_buffers_);
+    free_buffers_.push_back(static_cast<unsigned>(off / buffer_size_));
+  }
+
+  static constexpr unsigned short provided_buffer_group = 0;
+
+  // if operations could select a buffer from provided_buffer_group
+  bool has_provided_buffers() const noexcept {
+    return pbuf_ring_.br_ != nullptr;
+  }
+
+  // the provided buffer the kernel picked for the cqe, by the buffer id in
+  // its flags
+  clinux::iovec provided_buffer(unsigned short bid) const noexcept {
+    return {static_cast<char *>(pbufs_.p_) + bid * pbuf_size_, pbuf_size_};
+  }
+
+  // hands the provided buffer back to the kernel
+  void recycle_buffer(unsigned short bid) noexcept {
+    auto iov = provided_buffer(bid);
+    lock_guard<mutex> g_pbufs(m_pbufs_);
+    liburing::io_uring_buf_ring_add(
+        pbuf_ring_.br_, iov.iov_base, static_cast<unsigned>(iov.iov_len), bid,
+        liburing::io_uring_buf_ring_mask(pbuf_ring_.nr_), 0);
+    liburing::io_uring_buf_ring_advance(pbuf_ring_.br_, 1);
+  }
+
+  // the flags of the cqe, e.g. IORING_CQE_F_BUFFER, only valid inside the
+  // callback invoked for it
+  unsigned cqe_flags() const noexcept { return cqe_flags_; }
+
+  // if a send of sz bytes should be done with zero copy
+  bool use_zerocopy(size_t sz) const noexcept {
+    return zerocopy_threshold_ != 0 && sz >= zerocopy_threshold_ &&
+           zerocopy_supported_.load(memory_order_relaxed);
+  }
+
+  // zero copy sends are not tried again, e.g. on EOPNOTSUPP
+  void disable_zerocopy() noexcept {
+    zerocopy_supported_.store(false, memory_order_relaxed);
+  }
+
+  // takes an idle pipe from the pool, or creates one if none
+  result<kernel_pipe> acquire_pipe() noexcept {
+    {
+      lock_guard<mutex> g_pipes(m_pipes_);
+      if (!free_pipes_.empty()) {
+        kernel_pipe ret = move(free_pipes_.back());
+        free_pipes_.pop_back();
+        return move(ret);
+      }
+    }
+    return kernel_pipe::create(pipe_size_);
+  }
+
+  // gives the pipe back to the pool, unless bytes might be left in it or the
+  // pool is full, in which case it is closed
+  void release_pipe(kernel_pipe &&p, bool empty) noexcept {
+    if (!empty)
+      return;
+    lock_guard<mutex> g_pipes(m_pipes_);
+    if (free_pipes_.size() < max_free_pipes_)
+      free_pipes_.push_back(move(p));
+  }
+
+  // the index of the registered buffer [p, p + sz) lies in, -1 if none
+  int buffer_index(const void *p, size_t sz) const noexcept {
+    if (buffers_.p_ == nullptr)
+      return -1;
+    auto b = reinterpret_cast<uintptr_t>(buffers_.p_);
+    auto q = reinterpret_cast<uintptr_t>(p);
+    if (q < b || q - b > buffers_.sz_ || sz > buffers_.sz_ - (q - b))
+      return -1;
+    return 0;
+  }
+
+  unsigned setup_flags() const noexcept { return r_.flags(); }
+
+  size_t pending() noexcept {
     lock_guard<mutex> g_callbacks(m_callbacks_);
-    callbacks_.erase(token);
+    return callbacks_.size();
+  }
+
+  // invoked on the loop thread each time before it blocks waiting for
+  // completions, returning true keeps the loop from blocking for this
+  // iteration. must be set before run()
+  void set_idle_handler(idle_handler_t &&handler) noexcept {
+    idle_handler_ = forward<idle_handler_t>(handler);
   }
 
   result<void> run() noexcept {
+    // with IORING_SETUP_SINGLE_ISSUER, the thread enabling the ring becomes
+    // its only submitter, thus it is done here rather than in init()
+    if (!rings_enabled_) {
+      OUTCOME_TRY(r_.enable_rings());
+      rings_enabled_ = true;
+    }
+    loop_thread_.store(this_thread::get_id(), memory_order_relaxed);
     for (;;) {
       if (exiting_) {
         exiting_ = false;
+        loop_thread_.store(thread::id{}, memory_order_relaxed);
         if (exiting_error_) {
           error_code ret = exiting_error_;
           exiting_error_ = {};
@@ -162,42 +1007,60 @@ public:
           return success();
         }
       }
-      submit();
-      auto ret = r_.wait();
-      if (ret.has_error())
+      // the idle handler might have called exit() from the loop thread,
+      // which does not wake the loop up
+      bool busy = idle_handler_ ? idle_handler_() : false;
+      bool backlog = !flush_remote_sqes();
+      auto ret = submit_and_wait(busy || exiting_, backlog);
+      if (ret.has_error() && ret.error().value() != EINTR) {
+        loop_thread_.store(thread::id{}, memory_order_relaxed);
         return ret.as_failure();
+      }
 #ifdef ARK_ADVANCED_DEBUG_VERBOSITY
       cerr << "### WOKE" << endl;
 #endif
 
-      array<owning_cqe_ref, batch_size> cqe_buffer;
-      auto cqe_end = r_.peek_batch_cqe(cqe_buffer.begin(), batch_size);
-      list<pair<callback_t, result<long>>> run_callbacks;
+      // overflowed cqes, and task work with IORING_SETUP_COOP_TASKRUN, are
+      // flushed into the cq by the next io_uring_enter, which liburing makes
+      // sure to happen with IORING_ENTER_GETEVENTS
       {
         lock_guard<mutex> g_callbacks(m_callbacks_);
-        for (auto it = cqe_buffer.begin(); it != cqe_end; ++it) {
-          unowning_cqe_ref cqe{*it};
-
-          token_t tok = reinterpret_cast<token_t>(cqe.get_data());
+        r_.for_each_cqe(cqe_batch_, [this](unowning_cqe_ref cqe) {
+          token_t tok = cqe.get_data64();
 #ifdef ARK_ADVANCED_DEBUG_VERBOSITY
           cerr << "### GOT TOK IN CQE : " << tok << endl;
 #endif
-          auto it_callback = callbacks_.find(tok);
-          if (it_callback != callbacks_.end()) {
+          auto p_callback = callbacks_.find(tok);
+          if (p_callback == nullptr)
+            return;
 #ifdef ARK_ADVANCED_DEBUG_VERBOSITY
-            cerr << "### FOUND CALLBACK" << endl;
+          cerr << "### FOUND CALLBACK" << endl;
 #endif
-            run_callbacks.emplace_back(forward<callback_t>(it_callback->second),
-                                       cqe.to_result<long>());
-            callbacks_.erase(it_callback);
+          if (p_callback->cb_) {
+            run_callbacks_.push_back({move(p_callback->cb_), nullptr, tok,
+                                      cqe.to_result<long>(), cqe.flags(),
+                                      false});
+            callbacks_.erase(tok);
+          } else {
+            bool more = (cqe.flags() & IORING_CQE_F_MORE) != 0;
+            run_callbacks_.push_back({nullptr, addressof(p_callback->mcb_),
+                                      tok, cqe.to_result<long>(), cqe.flags(),
+                                      more});
           }
-
-          *it = {};
-        }
+        });
       }
-      for (auto &it : run_callbacks) {
-        it.first(it.second);
+      for (auto &it : run_callbacks_) {
+        cqe_flags_ = it.flags_;
+        if (it.p_mcb_ == nullptr) {
+          it.cb_(move(it.ret_));
+          continue;
+        }
+        (*it.p_mcb_)(move(it.ret_), it.more_);
+        if (!it.more_)
+          forget(it.tok_);
       }
+      run_callbacks_.clear();
+      cqe_flags_ = 0;
     }
   }
 
@@ -216,6 +1079,8 @@ public:
   using base_t = base_singlethread_uring_async_context;
   using token_t = base_t::token_t;
   using callback_t = base_t::callback_t;
+  using multishot_callback_t = base_t::multishot_callback_t;
+  using timer_entry = base_t::timer_entry;
 
 private:
   unique_ptr<base_t> base_;
@@ -224,13 +1089,15 @@ public:
   singlethread_uring_async_context() noexcept
       : base_(make_unique<base_singlethread_uring_async_context>()) {}
 
-  result<void> init() noexcept { return base_->init(); }
+  result<void> init(const uring_context_options &opts = {}) noexcept {
+    return base_->init(opts);
+  }
 
   result<void> wake() noexcept { return base_->wake(); }
 
   template <typename PrepSqeCallable // void prep_sqe(sqe_ref) noexcept
             >
-  result<void> add_sqe(const PrepSqeCallable &prep_sqe) noexcept {
+  result<token_t> add_sqe(const PrepSqeCallable &prep_sqe) noexcept {
     return base_->add_sqe(prep_sqe);
   }
 
@@ -241,7 +1108,99 @@ public:
     return base_->add_sqe(prep_sqe, forward<callback_t>(callback));
   }
 
-  void cancel(const token_t token) noexcept { base_->cancel(token); }
+  template <typename PrepSqeCallable // void prep_sqe(sqe_ref) noexcept
+            >
+  result<token_t>
+  add_multishot_sqe(const PrepSqeCallable &prep_sqe,
+                    multishot_callback_t &&callback) noexcept {
+    return base_->add_multishot_sqe(prep_sqe,
+                                    forward<multishot_callback_t>(callback));
+  }
+
+  template <typename PrepSqesCallable // void prep_sqes(sqe_ref, size_t i)
+                                      // noexcept
+            >
+  result<void> add_sqe_chain(const PrepSqesCallable &prep_sqes,
+                             span<callback_t> callbacks) noexcept {
+    return base_->add_sqe_chain(prep_sqes, callbacks);
+  }
+
+  result<void> cancel(const token_t token) noexcept {
+    return base_->cancel(token);
+  }
+
+  result<void> cancel_fd(sqe_file f) noexcept { return base_->cancel_fd(f); }
+
+  result<void> cancel_and_close(int fd) noexcept {
+    return base_->cancel_and_close(fd);
+  }
+
+  void arm_timer(timer_entry &e, chrono::nanoseconds d) noexcept {
+    base_->arm_timer(e, d);
+  }
+
+  void cancel_timer(timer_entry &e) noexcept { base_->cancel_timer(e); }
+
+  result<void> dispatch(unique_function<void()> &&fn) noexcept {
+    return base_->dispatch(move(fn));
+  }
+
+  result<int> register_file(int fd) noexcept {
+    return base_->register_file(fd);
+  }
+
+  result<void> close_file(int slot) noexcept {
+    return base_->close_file(slot);
+  }
+
+  bool direct_accept() const noexcept { return base_->direct_accept(); }
+
+  result<clinux::iovec> acquire_buffer() noexcept {
+    return base_->acquire_buffer();
+  }
+
+  void release_buffer(const void *p) noexcept { base_->release_buffer(p); }
+
+  int buffer_index(const void *p, size_t sz) const noexcept {
+    return base_->buffer_index(p, sz);
+  }
+
+  static constexpr unsigned short provided_buffer_group =
+      base_t::provided_buffer_group;
+
+  bool has_provided_buffers() const noexcept {
+    return base_->has_provided_buffers();
+  }
+
+  clinux::iovec provided_buffer(unsigned short bid) const noexcept {
+    return base_->provided_buffer(bid);
+  }
+
+  void recycle_buffer(unsigned short bid) noexcept {
+    base_->recycle_buffer(bid);
+  }
+
+  unsigned cqe_flags() const noexcept { return base_->cqe_flags(); }
+
+  bool use_zerocopy(size_t sz) const noexcept {
+    return base_->use_zerocopy(sz);
+  }
+
+  void disable_zerocopy() noexcept { base_->disable_zerocopy(); }
+
+  result<kernel_pipe> acquire_pipe() noexcept { return base_->acquire_pipe(); }
+
+  void release_pipe(kernel_pipe &&p, bool empty) noexcept {
+    base_->release_pipe(move(p), empty);
+  }
+
+  unsigned setup_flags() const noexcept { return base_->setup_flags(); }
+
+  size_t pending() noexcept { return base_->pending(); }
+
+  void set_idle_handler(base_t::idle_handler_t &&handler) noexcept {
+    base_->set_idle_handler(forward<base_t::idle_handler_t>(handler));
+  }
 
   result<void> run() noexcept { return base_->run(); }
 
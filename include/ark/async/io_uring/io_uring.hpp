@@ -10,28 +10,79 @@ namespace ark {
 namespace io_uring_async {
 namespace liburing {
 using ::io_uring;
+using ::io_uring_buf_ring;
+using ::io_uring_buf_ring_add;
+using ::io_uring_buf_ring_advance;
+using ::io_uring_buf_ring_mask;
+using ::io_uring_cq_advance;
 using ::io_uring_cqe;
 using ::io_uring_cqe_get_data;
+using ::io_uring_cqe_get_data64;
 using ::io_uring_cqe_seen;
+using ::io_uring_enable_rings;
+using ::io_uring_free_buf_ring;
 using ::io_uring_get_sqe;
+using ::io_uring_params;
 using ::io_uring_peek_batch_cqe;
 using ::io_uring_prep_accept;
+using ::io_uring_prep_accept_direct;
+using ::io_uring_prep_cancel64;
+using ::io_uring_prep_cancel_fd;
+using ::io_uring_prep_close;
+using ::io_uring_prep_close_direct;
 using ::io_uring_prep_connect;
+using ::io_uring_prep_fsync;
+using ::io_uring_prep_link_timeout;
+using ::io_uring_prep_multishot_accept;
+using ::io_uring_prep_multishot_accept_direct;
 using ::io_uring_prep_nop;
 using ::io_uring_prep_poll_add;
 using ::io_uring_prep_read;
+using ::io_uring_prep_read_fixed;
+using ::io_uring_prep_timeout;
+using ::io_uring_prep_timeout_remove;
 using ::io_uring_prep_readv;
+using ::io_uring_prep_recvmsg;
+using ::io_uring_prep_recv_multishot;
+using ::io_uring_prep_sendmsg;
+using ::io_uring_prep_sendmsg_zc;
+using ::io_uring_prep_shutdown;
+using ::io_uring_prep_splice;
+using ::io_uring_prep_tee;
 using ::io_uring_prep_write;
+using ::io_uring_prep_write_fixed;
 using ::io_uring_prep_writev;
 using ::io_uring_queue_exit;
 using ::io_uring_queue_init;
+using ::io_uring_queue_init_params;
+using ::io_uring_register_buffers;
+using ::io_uring_register_file_alloc_range;
+using ::io_uring_register_files_sparse;
+using ::io_uring_register_files_update;
+using ::io_uring_setup_buf_ring;
+using ::io_uring_sq_space_left;
 using ::io_uring_sqe;
 using ::io_uring_sqe_set_data;
+using ::io_uring_sqe_set_data64;
 using ::io_uring_sqe_set_flags;
+using ::io_uring_sqring_wait;
 using ::io_uring_submit;
+using ::io_uring_submit_and_get_events;
+using ::io_uring_submit_and_wait;
+using ::io_uring_submit_and_wait_timeout;
 using ::io_uring_wait_cqe;
 } // namespace liburing
 
+// the file an sqe operates on, a fildes, or a slot of the registered file
+// table of the ring, used with IOSQE_FIXED_FILE
+struct sqe_file {
+  int fd_;
+  bool fixed_{false};
+
+  sqe_file(int fd) noexcept : fd_(fd) {}
+  sqe_file(int fd, bool fixed) noexcept : fd_(fd), fixed_(fixed) {}
+};
+
 class sqe_ref {
 private:
   liburing::io_uring_sqe *sqe_;
@@ -51,6 +102,19 @@ public:
     liburing::io_uring_prep_write(sqe_, fd, buf, nbytes, offset);
   }
 
+  // buf must lie in the registered buffer at buf_index
+  void prep_read_fixed(int fd, void *buf, unsigned nbytes,
+                       clinux::off_t offset, int buf_index) noexcept {
+    liburing::io_uring_prep_read_fixed(sqe_, fd, buf, nbytes, offset,
+                                       buf_index);
+  }
+
+  void prep_write_fixed(int fd, const void *buf, unsigned nbytes,
+                        clinux::off_t offset, int buf_index) noexcept {
+    liburing::io_uring_prep_write_fixed(sqe_, fd, buf, nbytes, offset,
+                                        buf_index);
+  }
+
   void prep_readv(int fd, const clinux::iovec *iovecs, unsigned nr_vecs,
                   clinux::off_t offset) noexcept {
     liburing::io_uring_prep_readv(sqe_, fd, iovecs, nr_vecs, offset);
@@ -61,6 +125,50 @@ public:
     liburing::io_uring_prep_writev(sqe_, fd, iovecs, nr_vecs, offset);
   }
 
+  // stays armed, posting a cqe with IORING_CQE_F_MORE for each chunk
+  // received, used with buffer select, requires kernel >= 6.0
+  void prep_recv_multishot(int fd, void *buf, size_t len, int flags) noexcept {
+    liburing::io_uring_prep_recv_multishot(sqe_, fd, buf, len, flags);
+  }
+
+  void prep_sendmsg(int fd, const clinux::msghdr *msg,
+                    unsigned flags) noexcept {
+    liburing::io_uring_prep_sendmsg(sqe_, fd, msg, flags);
+  }
+
+  void prep_recvmsg(int fd, clinux::msghdr *msg, unsigned flags) noexcept {
+    liburing::io_uring_prep_recvmsg(sqe_, fd, msg, flags);
+  }
+
+  // completes with the result, then with a notification cqe flagged
+  // IORING_CQE_F_NOTIF once the kernel no longer uses the buffers, if the
+  // first one is flagged IORING_CQE_F_MORE, requires kernel >= 6.1
+  void prep_sendmsg_zc(int fd, const clinux::msghdr *msg,
+                       unsigned flags) noexcept {
+    liburing::io_uring_prep_sendmsg_zc(sqe_, fd, msg, flags);
+  }
+
+  // moves up to nbytes between fd_in and fd_out, one of which must be a pipe,
+  // without copying them to user space. An offset of -1 is for pipes and
+  // sockets, and makes the others use the kernel offset
+  void prep_splice(int fd_in, int64_t off_in, int fd_out, int64_t off_out,
+                   unsigned nbytes, unsigned flags) noexcept {
+    liburing::io_uring_prep_splice(sqe_, fd_in, off_in, fd_out, off_out,
+                                   nbytes, flags);
+  }
+
+  // duplicates up to nbytes from pipe fd_in to pipe fd_out, leaving them in
+  // fd_in
+  void prep_tee(int fd_in, int fd_out, unsigned nbytes,
+                unsigned flags) noexcept {
+    liburing::io_uring_prep_tee(sqe_, fd_in, fd_out, nbytes, flags);
+  }
+
+  // requires kernel >= 5.11
+  void prep_shutdown(int fd, int how) noexcept {
+    liburing::io_uring_prep_shutdown(sqe_, fd, how);
+  }
+
   void prep_connect(int fd, const clinux::sockaddr *addr,
                     clinux::socklen_t addrlen) noexcept {
     liburing::io_uring_prep_connect(sqe_, fd, addr, addrlen);
@@ -71,18 +179,98 @@ public:
     liburing::io_uring_prep_accept(sqe_, fd, addr, addrlen, flags);
   }
 
+  // stays armed, posting a cqe with IORING_CQE_F_MORE for each accepted
+  // socket, requires kernel >= 5.19
+  void prep_multishot_accept(int fd, clinux::sockaddr *addr,
+                             clinux::socklen_t *addrlen, int flags) noexcept {
+    liburing::io_uring_prep_multishot_accept(sqe_, fd, addr, addrlen, flags);
+  }
+
+  // the accepted sockets are placed at free slots of the registered file
+  // table, whose indexes are the results
+  void prep_multishot_accept_direct(int fd, clinux::sockaddr *addr,
+                                    clinux::socklen_t *addrlen,
+                                    int flags) noexcept {
+    liburing::io_uring_prep_multishot_accept_direct(sqe_, fd, addr, addrlen,
+                                                    flags);
+  }
+
+  // the accepted socket is placed in the registered file table at file_index,
+  // or at a free slot with IORING_FILE_INDEX_ALLOC, whose index is the result
+  void prep_accept_direct(int fd, clinux::sockaddr *addr,
+                          clinux::socklen_t *addrlen, int flags,
+                          unsigned file_index) noexcept {
+    liburing::io_uring_prep_accept_direct(sqe_, fd, addr, addrlen, flags,
+                                          file_index);
+  }
+
+  void prep_cancel64(uint64_t user_data, int flags) noexcept {
+    liburing::io_uring_prep_cancel64(sqe_, user_data, flags);
+  }
+
+  void prep_cancel_fd(int fd, unsigned flags) noexcept {
+    liburing::io_uring_prep_cancel_fd(sqe_, fd, flags);
+  }
+
+  void prep_close(int fd) noexcept { liburing::io_uring_prep_close(sqe_, fd); }
+
+  void prep_close_direct(unsigned file_index) noexcept {
+    liburing::io_uring_prep_close_direct(sqe_, file_index);
+  }
+
+  void prep_fsync(int fd, unsigned fsync_flags) noexcept {
+    liburing::io_uring_prep_fsync(sqe_, fd, fsync_flags);
+  }
+
   void prep_poll_add(int fd, short poll_mask) noexcept {
     liburing::io_uring_prep_poll_add(sqe_, fd, poll_mask);
   }
 
+  void prep_timeout(clinux::__kernel_timespec *ts, unsigned count,
+                    unsigned flags) noexcept {
+    liburing::io_uring_prep_timeout(sqe_, ts, count, flags);
+  }
+
+  void prep_timeout_remove(uint64_t user_data, unsigned flags) noexcept {
+    liburing::io_uring_prep_timeout_remove(sqe_, user_data, flags);
+  }
+
+  // must directly follow an sqe flagged with IOSQE_IO_LINK
+  void prep_link_timeout(clinux::__kernel_timespec *ts,
+                         unsigned flags) noexcept {
+    liburing::io_uring_prep_link_timeout(sqe_, ts, flags);
+  }
+
   void set_data(void *data) noexcept {
     liburing::io_uring_sqe_set_data(sqe_, data);
   }
 
+  void set_data64(uint64_t data) noexcept {
+    liburing::io_uring_sqe_set_data64(sqe_, data);
+  }
+
   void set_flags(unsigned flags) noexcept {
     liburing::io_uring_sqe_set_flags(sqe_, flags);
   }
 
+  // keeps the flags set by prep, e.g. IOSQE_FIXED_FILE
+  void add_flags(unsigned flags) noexcept {
+    liburing::io_uring_sqe_set_flags(sqe_, sqe_->flags | flags);
+  }
+
+  // the kernel picks the buffer from the provided buffer group bgid, the
+  // buffer id is then reported in the flags of the cqe
+  void set_buffer_select(unsigned short bgid) noexcept {
+    add_flags(IOSQE_BUFFER_SELECT);
+    sqe_->buf_group = bgid;
+  }
+
+  // called after prep with f.fd_
+  void add_file_flags(sqe_file f) noexcept {
+    if (f.fixed_)
+      add_flags(IOSQE_FIXED_FILE);
+  }
+
 #ifdef ARK_ADVANCED_DEBUG_VERBOSITY
   void dump() noexcept {
     cerr << "===SQE INFO===" << endl;
@@ -126,6 +314,9 @@ public:
   cqe_ref(not_null<liburing::io_uring_cqe *> cqe, io_uring &parent) noexcept
       : cqe_(cqe), parent_(&parent) {}
 
+  template <bool UOwning = Owning, enable_if_t<!UOwning, int> = 0>
+  cqe_ref(not_null<liburing::io_uring_cqe *> cqe) noexcept : cqe_(cqe) {}
+
   template <bool UOwning = Owning, enable_if_t<!UOwning, int> = 0>
   cqe_ref(cqe_ref<true> &from) noexcept : cqe_{from.cqe_} {}
 
@@ -171,6 +362,12 @@ public:
 
   void *get_data() noexcept { return liburing::io_uring_cqe_get_data(cqe_); }
 
+  uint64_t get_data64() noexcept {
+    return liburing::io_uring_cqe_get_data64(cqe_);
+  }
+
+  unsigned flags() noexcept { return cqe_->flags; }
+
   template <typename ResType> result<ResType> to_result() noexcept {
     if (cqe_->res < 0) {
       return error_code{-cqe_->res, system_category()};
@@ -202,6 +399,103 @@ public:
     return success();
   }
 
+  result<void> queue_init(unsigned entries,
+                          liburing::io_uring_params &params) noexcept {
+    Expects(!inited_);
+    int ret = liburing::io_uring_queue_init_params(entries, &ring_, &params);
+    if (ret < 0) {
+      return as_ec(-ret);
+    }
+    inited_ = true;
+    return success();
+  }
+
+  unsigned features() const noexcept {
+    Expects(inited_);
+    return ring_.features;
+  }
+
+  // the IORING_SETUP_* flags the ring was created with
+  unsigned flags() const noexcept {
+    Expects(inited_);
+    return ring_.flags;
+  }
+
+  // pins the memory of each iovec, which is then referred to by its index,
+  // charged against RLIMIT_MEMLOCK before kernel 5.12
+  result<void> register_buffers(const clinux::iovec *iovecs,
+                                unsigned nr) noexcept {
+    Expects(inited_);
+    int ret = liburing::io_uring_register_buffers(&ring_, iovecs, nr);
+    if (ret < 0) {
+      return as_ec(-ret);
+    }
+    return success();
+  }
+
+  // a ring of nr provided buffers for group bgid, nr must be a power of 2,
+  // requires kernel >= 5.19
+  result<liburing::io_uring_buf_ring *> setup_buf_ring(unsigned nr,
+                                                       int bgid) noexcept {
+    Expects(inited_);
+    int ret = 0;
+    auto br = liburing::io_uring_setup_buf_ring(&ring_, nr, bgid, 0, &ret);
+    if (br == nullptr) {
+      return as_ec(-ret);
+    }
+    return br;
+  }
+
+  void free_buf_ring(liburing::io_uring_buf_ring *br, unsigned nr,
+                     int bgid) noexcept {
+    Expects(inited_);
+    liburing::io_uring_free_buf_ring(&ring_, br, nr, bgid);
+  }
+
+  // a table of nr empty slots, requires kernel >= 5.19
+  result<void> register_files_sparse(unsigned nr) noexcept {
+    Expects(inited_);
+    int ret = liburing::io_uring_register_files_sparse(&ring_, nr);
+    if (ret < 0) {
+      return as_ec(-ret);
+    }
+    return success();
+  }
+
+  // -1 in fds empties the slot, dropping the reference of the table to the
+  // file
+  result<void> register_files_update(unsigned off, const int *fds,
+                                     unsigned nr) noexcept {
+    Expects(inited_);
+    int ret = liburing::io_uring_register_files_update(&ring_, off, fds, nr);
+    if (ret < 0) {
+      return as_ec(-ret);
+    }
+    return success();
+  }
+
+  // slots IORING_FILE_INDEX_ALLOC picks from, requires kernel >= 6.0
+  result<void> register_file_alloc_range(unsigned off, unsigned len) noexcept {
+    Expects(inited_);
+    int ret = liburing::io_uring_register_file_alloc_range(&ring_, off, len);
+    if (ret < 0) {
+      return as_ec(-ret);
+    }
+    return success();
+  }
+
+  // for rings created with IORING_SETUP_R_DISABLED, with
+  // IORING_SETUP_SINGLE_ISSUER the calling thread becomes the only one allowed
+  // to submit
+  result<void> enable_rings() noexcept {
+    Expects(inited_);
+    int ret = liburing::io_uring_enable_rings(&ring_);
+    if (ret < 0) {
+      return as_ec(-ret);
+    }
+    return success();
+  }
+
   result<sqe_ref> get_sqe() noexcept {
     Expects(inited_);
     liburing::io_uring_sqe *ret = liburing::io_uring_get_sqe(&ring_);
@@ -211,11 +505,68 @@ public:
     return as_ec(ENOBUFS);
   }
 
+  unsigned sq_space_left() noexcept {
+    Expects(inited_);
+    return liburing::io_uring_sq_space_left(&ring_);
+  }
+
+  unsigned sq_entries() const noexcept { return ring_.sq.ring_entries; }
+
+  // with IORING_SETUP_SQPOLL, this only publishes the new sq tail, and enters
+  // the kernel (with IORING_ENTER_SQ_WAKEUP) only if the sq thread went idle
+  // and raised IORING_SQ_NEED_WAKEUP, which liburing checks for us
   int submit() noexcept {
     Expects(inited_);
     return liburing::io_uring_submit(&ring_);
   }
 
+  // also enters the kernel with IORING_ENTER_GETEVENTS even if there is
+  // nothing to submit, which is the only way to get completions reaped with
+  // IORING_SETUP_DEFER_TASKRUN
+  int submit_and_get_events() noexcept {
+    Expects(inited_);
+    return liburing::io_uring_submit_and_get_events(&ring_);
+  }
+
+  // flushes the sq and waits for at least wait_nr cqes in one io_uring_enter
+  result<void> submit_and_wait(unsigned wait_nr) noexcept {
+    Expects(inited_);
+    int ret = liburing::io_uring_submit_and_wait(&ring_, wait_nr);
+    if (ret < 0) {
+      return as_ec(-ret);
+    }
+    return success();
+  }
+
+  // same as above, but gives up after timeout, which is not an error. without
+  // IORING_FEAT_EXT_ARG, liburing queues an internal timeout sqe with
+  // user_data LIBURING_UDATA_TIMEOUT for that
+  result<void> submit_and_wait_timeout(unsigned wait_nr,
+                                       chrono::nanoseconds timeout) noexcept {
+    Expects(inited_);
+    auto secs = chrono::duration_cast<chrono::seconds>(timeout);
+    clinux::__kernel_timespec ts{};
+    ts.tv_sec = secs.count();
+    ts.tv_nsec = (timeout - secs).count();
+    liburing::io_uring_cqe *p_discarded;
+    int ret = liburing::io_uring_submit_and_wait_timeout(
+        &ring_, &p_discarded, wait_nr, &ts, nullptr);
+    if (ret < 0 && ret != -ETIME) {
+      return as_ec(-ret);
+    }
+    return success();
+  }
+
+  // with IORING_SETUP_SQPOLL, waits until the sq thread made room in the sq
+  result<void> sqring_wait() noexcept {
+    Expects(inited_);
+    int ret = liburing::io_uring_sqring_wait(&ring_);
+    if (ret < 0) {
+      return as_ec(-ret);
+    }
+    return success();
+  }
+
   result<void> wait() noexcept {
     Expects(inited_);
     liburing::io_uring_cqe *p_discarded;
@@ -238,6 +589,24 @@ public:
     return it;
   }
 
+  // invokes f(unowning_cqe_ref) on at most max_n available cqes, then marks
+  // all of them seen at once, returns the number of cqes visited. Unlike
+  // peek_batch_cqe, never allocates nor enters the kernel.
+  template <typename F> unsigned for_each_cqe(unsigned max_n, F &&f) noexcept {
+    Expects(inited_);
+    unsigned head;
+    unsigned n = 0;
+    liburing::io_uring_cqe *cqe;
+    io_uring_for_each_cqe(&ring_, head, cqe) {
+      if (n == max_n)
+        break;
+      f(unowning_cqe_ref{cqe});
+      n++;
+    }
+    liburing::io_uring_cq_advance(&ring_, n);
+    return n;
+  }
+
   ~io_uring() {
     if (inited_) {
       liburing::io_uring_queue_exit(&ring_);
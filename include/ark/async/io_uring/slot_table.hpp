@@ -0,0 +1,157 @@
+#pragma once
+
+/*! \cond FILE_NOT_DOCUMENTED */
+
+#include <ark/bindings.hpp>
+
+namespace ark {
+namespace io_uring_async {
+
+/*
+ * A slab of completion callbacks, addressed by tokens that are stored as the
+ * user_data of submitted sqes.
+ *
+ * A token encodes the slot index in its lower 32 bits, and the generation of
+ * the slot in its upper 32 bits. The generation is bumped each time a slot is
+ * released, so a token that outlived its slot (e.g. the cqe of an operation
+ * whose callback was already dropped) never matches the next occupant.
+ * Generations start from 1, thus 0 is never a valid token.
+ *
+ * Slots are allocated in fixed-size chunks which are never moved nor freed
+ * before the table itself, released slots are kept in an intrusive free list.
+ * Once the table has grown to the peak number of in-flight operations,
+ * emplace(), find() and erase() are O(1) and never allocate.
+ */
+template <typename Callback> class slot_table {
+public:
+  using token_t = uint64_t;
+
+  static const constexpr token_t null_token = 0;
+
+private:
+  static const constexpr uint32_t chunk_size = 256;
+  static const constexpr uint32_t npos = numeric_limits<uint32_t>::max();
+
+  struct slot {
+    Callback cb_;
+    uint32_t generation_{1};
+    uint32_t next_free_{npos};
+    bool used_{false};
+  };
+
+  vector<unique_ptr<slot[]>> chunks_;
+  uint32_t free_head_{npos};
+  size_t size_{0};
+
+  static token_t make_token(uint32_t index, uint32_t generation) noexcept {
+    return (static_cast<token_t>(generation) << 32) | index;
+  }
+
+  static uint32_t index_of(token_t tok) noexcept {
+    return static_cast<uint32_t>(tok & 0xffffffffu);
+  }
+
+  static uint32_t generation_of(token_t tok) noexcept {
+    return static_cast<uint32_t>(tok >> 32);
+  }
+
+  uint32_t capacity_u32() const noexcept {
+    return static_cast<uint32_t>(chunks_.size()) * chunk_size;
+  }
+
+  slot &at(uint32_t index) noexcept {
+    return chunks_[index / chunk_size][index % chunk_size];
+  }
+
+  void grow() noexcept {
+    uint32_t base = capacity_u32();
+    chunks_.emplace_back(make_unique<slot[]>(chunk_size));
+    for (uint32_t i = chunk_size; i > 0; --i) {
+      slot &s = at(base + i - 1);
+      s.next_free_ = free_head_;
+      free_head_ = base + i - 1;
+    }
+  }
+
+  slot *lookup(token_t tok) noexcept {
+    uint32_t index = index_of(tok);
+    if (index >= capacity_u32())
+      return nullptr;
+    slot &s = at(index);
+    if (!s.used_ || s.generation_ != generation_of(tok))
+      return nullptr;
+    return addressof(s);
+  }
+
+public:
+  slot_table() noexcept {}
+
+  /*
+   * make sure at least n slots could be occupied without allocating
+   */
+  void reserve(size_t n) noexcept {
+    while (capacity_u32() < n)
+      grow();
+  }
+
+  /*
+   * occupy a slot with the given callback, returns its token
+   */
+  token_t emplace(Callback &&cb) noexcept {
+    if (free_head_ == npos)
+      grow();
+    uint32_t index = free_head_;
+    slot &s = at(index);
+    free_head_ = s.next_free_;
+    s.next_free_ = npos;
+    s.used_ = true;
+    s.cb_ = forward<Callback>(cb);
+    ++size_;
+    return make_token(index, s.generation_);
+  }
+
+  /*
+   * returns the callback occupying the slot, or nullptr if the token is stale
+   *
+   * the returned pointer stays valid until the slot is erased, even if other
+   * slots are emplaced in the meantime
+   */
+  Callback *find(token_t tok) noexcept {
+    slot *s = lookup(tok);
+    if (s == nullptr)
+      return nullptr;
+    return addressof(s->cb_);
+  }
+
+  /*
+   * release the slot, returns false if the token is stale
+   */
+  bool erase(token_t tok) noexcept {
+    slot *s = lookup(tok);
+    if (s == nullptr)
+      return false;
+    s->cb_ = Callback{};
+    s->used_ = false;
+    if (++s->generation_ == 0)
+      s->generation_ = 1;
+    s->next_free_ = free_head_;
+    free_head_ = index_of(tok);
+    --size_;
+    return true;
+  }
+
+  /*
+   * number of occupied slots
+   */
+  size_t size() const noexcept { return size_; }
+
+  slot_table(slot_table &&) = delete;
+  slot_table &operator=(slot_table &&) = delete;
+  slot_table(const slot_table &) = delete;
+  slot_table &operator=(const slot_table &) = delete;
+};
+
+} // namespace io_uring_async
+} // namespace ark
+
+/*! \endcond */
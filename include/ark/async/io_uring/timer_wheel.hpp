@@ -0,0 +1,190 @@
+#pragma once
+
+/*! \cond FILE_NOT_DOCUMENTED */
+
+#include <ark/bindings.hpp>
+
+namespace ark {
+namespace io_uring_async {
+
+/*
+ * A hierarchical timing wheel, the same as the one of linux before 4.8.
+ *
+ * Time is counted in ticks. The root level has a slot for each of the next 256
+ * ticks, each of the upper levels has 64 slots covering 64 times the span of
+ * the level below. Entries far away are kept in the upper levels, and cascaded
+ * down each time the level below wraps around, so that they end up in the
+ * root level once they are within 256 ticks.
+ *
+ * Entries are intrusive doubly linked list nodes, thus arming, re-arming and
+ * cancelling are O(1) and never allocate. Advancing is O(1) per tick, plus the
+ * entries cascaded or expired. Not thread safe.
+ */
+class timer_wheel {
+  struct link {
+    link *prev_{this};
+    link *next_{this};
+
+    link() noexcept = default;
+    link(const link &) = delete;
+    link &operator=(const link &) = delete;
+
+    bool linked() const noexcept { return next_ != this; }
+
+    void insert_before(link &l) noexcept {
+      prev_ = l.prev_;
+      next_ = &l;
+      l.prev_->next_ = this;
+      l.prev_ = this;
+    }
+
+    void unlink() noexcept {
+      prev_->next_ = next_;
+      next_->prev_ = prev_;
+      prev_ = next_ = this;
+    }
+
+    // moves all the nodes of list head l to the end of this list head
+    void splice(link &l) noexcept {
+      if (!l.linked())
+        return;
+      l.next_->prev_ = prev_;
+      prev_->next_ = l.next_;
+      l.prev_->next_ = this;
+      prev_ = l.prev_;
+      l.prev_ = l.next_ = &l;
+    }
+  };
+
+public:
+  using callback_t = unique_function<void()>;
+
+  // must not outlive the wheel it is armed on, destroying it cancels it
+  class entry : private link {
+    friend class timer_wheel;
+
+    timer_wheel *wheel_{nullptr};
+    uint64_t expires_{0};
+    callback_t cb_;
+
+  public:
+    entry() noexcept = default;
+    explicit entry(callback_t &&cb) noexcept : cb_(forward<callback_t>(cb)) {}
+
+    // invoked on the loop thread when expired, the entry is disarmed by then
+    // and could be re-armed from inside
+    void set_callback(callback_t &&cb) noexcept {
+      cb_ = forward<callback_t>(cb);
+    }
+
+    bool armed() const noexcept { return linked(); }
+
+    void cancel() noexcept {
+      if (!linked())
+        return;
+      unlink();
+      wheel_->size_--;
+    }
+
+    ~entry() noexcept { cancel(); }
+  };
+
+private:
+  static const constexpr unsigned root_bits = 8;
+  static const constexpr unsigned level_bits = 6;
+  static const constexpr unsigned levels = 4;
+  static const constexpr uint64_t root_size = 1 << root_bits;
+  static const constexpr uint64_t level_size = 1 << level_bits;
+  // entries further away are clamped to it, about 13 years of 100ms ticks
+  static const constexpr uint64_t max_ticks = uint64_t{1}
+                                              << (root_bits +
+                                                  levels * level_bits);
+
+  array<link, root_size> root_;
+  array<array<link, level_size>, levels> levels_;
+  // next tick to be processed
+  uint64_t current_{0};
+  size_t size_{0};
+
+  link &slot_of(uint64_t expires) noexcept {
+    uint64_t delta = expires - current_;
+    if (delta < root_size)
+      return root_[expires & (root_size - 1)];
+    for (unsigned l = 0; l < levels; l++) {
+      unsigned shift = root_bits + l * level_bits;
+      if (delta < (uint64_t{1} << (shift + level_bits)))
+        return levels_[l][(expires >> shift) & (level_size - 1)];
+    }
+    // unreachable as delta is clamped
+    return root_[expires & (root_size - 1)];
+  }
+
+  // re-inserts the entries of a slot, which are now closer
+  void cascade(link &head) noexcept {
+    link tmp;
+    tmp.splice(head);
+    while (tmp.linked()) {
+      link *l = tmp.next_;
+      l->unlink();
+      l->insert_before(slot_of(static_cast<entry *>(l)->expires_));
+    }
+  }
+
+public:
+  timer_wheel() noexcept = default;
+  timer_wheel(const timer_wheel &) = delete;
+  timer_wheel &operator=(const timer_wheel &) = delete;
+
+  uint64_t current() const noexcept { return current_; }
+  bool empty() const noexcept { return size_ == 0; }
+  size_t size() const noexcept { return size_; }
+
+  // jumps to tick, only allowed while empty
+  void reset(uint64_t tick) noexcept {
+    Expects(empty());
+    current_ = tick;
+  }
+
+  // expires on processing of tick current() + ticks, re-arms if already armed
+  void arm(entry &e, uint64_t ticks) noexcept {
+    e.cancel();
+    ticks = clamp(ticks, uint64_t{1}, max_ticks - 1);
+    e.wheel_ = this;
+    e.expires_ = current_ + ticks;
+    e.insert_before(slot_of(e.expires_));
+    size_++;
+  }
+
+  // processes the ticks till tick (inclusive), invoking the expired entries
+  void advance(uint64_t tick) noexcept {
+    while (current_ <= tick) {
+      uint64_t idx = current_ & (root_size - 1);
+      if (idx == 0) {
+        for (unsigned l = 0; l < levels; l++) {
+          unsigned shift = root_bits + l * level_bits;
+          uint64_t i = (current_ >> shift) & (level_size - 1);
+          cascade(levels_[l][i]);
+          if (i != 0)
+            break;
+        }
+      }
+      // entries re-armed by the callbacks land after current_, as it is only
+      // bumped afterwards, but never in the list being invoked
+      link expired;
+      expired.splice(root_[idx]);
+      while (expired.linked()) {
+        auto *e = static_cast<entry *>(expired.next_);
+        e->unlink();
+        size_--;
+        if (e->cb_)
+          e->cb_();
+      }
+      current_++;
+    }
+  }
+};
+
+} // namespace io_uring_async
+} // namespace ark
+
+/*! \endcond */
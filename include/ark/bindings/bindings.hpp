@@ -2,7 +2,10 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <deque>
 #include <function2/function2.hpp>
 #include <gsl/gsl>
 #include <iostream>
@@ -15,6 +18,7 @@
 #include <sstream>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -46,15 +50,19 @@ using std::add_const_t;
 using std::add_pointer_t;
 using std::addressof;
 using std::array;
+using std::atomic;
+using std::atomic_thread_fence;
 using std::basic_string;
 using std::basic_string_view;
 using std::begin;
 using std::cbegin;
 using std::cend;
 using std::cerr;
+using std::clamp;
 using std::conditional_t;
 using std::copy;
 using std::declval;
+using std::deque;
 using std::enable_if_t;
 using std::end;
 using std::endl;
@@ -66,6 +74,7 @@ using std::fill;
 using std::forward;
 using std::is_const_v;
 using std::is_convertible_v;
+using std::is_default_constructible_v;
 using std::is_pointer_v;
 using std::is_same_v;
 using std::is_standard_layout_v;
@@ -76,26 +85,39 @@ using std::list;
 using std::lock_guard;
 using std::make_error_code;
 using std::make_pair;
+using std::make_shared;
 using std::make_unique;
 using std::map;
 using std::max;
 using std::min;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::memory_order_seq_cst;
 using std::move;
 using std::mutex;
+using std::nullopt;
 using std::numeric_limits;
 using std::optional;
 using std::ostringstream;
 using std::pair;
+using std::remove;
 using std::remove_const_t;
+using std::shared_ptr;
 using std::size_t;
 using std::string;
 using std::stringstream;
 using std::system_category;
+using std::swap;
 using std::system_error;
 using std::terminate;
+using std::thread;
 using std::true_type;
+using std::unique_lock;
 using std::unique_ptr;
 using std::vector;
+namespace chrono = std::chrono;
+namespace this_thread = std::this_thread;
 
 /*! \endcond */
 
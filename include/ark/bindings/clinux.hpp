@@ -18,10 +18,13 @@ namespace clinux {}
 extern "C" {
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <linux/time_types.h>
 #include <linux/version.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
+#include <netinet/udp.h>
 #include <poll.h>
+#include <sched.h>
 #include <signal.h>
 #include <sys/eventfd.h>
 #include <sys/mman.h>
@@ -34,11 +37,15 @@ extern "C" {
 
 namespace ark {
 namespace clinux {
+using ::__kernel_timespec;
 using ::accept4;
 using ::bind;
+using ::cmsghdr;
 using ::close;
 using ::connect;
+using ::cpu_set_t;
 using ::eventfd;
+using ::fcntl;
 using ::htons;
 using ::inet_ntop;
 using ::inet_pton;
@@ -48,6 +55,10 @@ using ::loff_t;
 using ::lseek;
 using ::memfd_create;
 using ::mkostemp;
+using ::msghdr;
+using ::mmap;
+using ::mmsghdr;
+using ::munmap;
 using ::ntohs;
 using ::off_t;
 using ::open;
@@ -56,7 +67,14 @@ using ::preadv2;
 using ::pwritev2;
 using ::read;
 using ::readv;
+using ::recvmmsg;
+using ::recvmsg;
+using ::sched_getaffinity;
+using ::sched_setaffinity;
 using ::sa_family_t;
+using ::sendmmsg;
+using ::sendmsg;
+using ::setsockopt;
 using ::signal;
 using ::sockaddr;
 using ::sockaddr_in;
@@ -65,6 +83,7 @@ using ::sockaddr_storage;
 using ::socket;
 using ::socklen_t;
 using ::splice;
+using ::sysconf;
 using ::vmsplice;
 using ::write;
 using ::writev;
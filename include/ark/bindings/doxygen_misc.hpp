@@ -41,7 +41,60 @@
  * \example coro_echo_server.cpp
  *
  * This is an echo server, implemented using coroutines. It is able to handle
- * multiple connections in a single thread.
+ * multiple connections in a single thread. The data is read into buffers of
+ * the provided buffer ring, see \ref ::ark::async::read_some.
+ */
+
+/*!
+ * \example coro_pool_echo_server.cpp
+ *
+ * This is an echo server, implemented using coroutines and an
+ * async_context_pool. Connections are spread among the contexts of the pool,
+ * one per core.
+ */
+
+/*!
+ * \example coro_skewed_echo_bench.cpp
+ *
+ * This is a benchmark of work_stealing_scheduler. All the connections of an
+ * echo server are bound to the same context of a pool, with some cpu time
+ * spent on each request. Run it with 1 or 0 as the first argument to compare
+ * the round trips per second with and without work stealing.
+ */
+
+/*!
+ * \example coro_ring_setup_bench.cpp
+ *
+ * This is a benchmark of the setup policies of async_context. An echo server
+ * and its clients run on two contexts on different threads. Run it with
+ * basic, cooperative or single_issuer as the first argument to compare the
+ * round trips, IPIs and context switches per second.
+ */
+
+/*!
+ * \example coro_fixed_buffer_bench.cpp
+ *
+ * This is a benchmark of the registered buffer pool of async_context. Blocks
+ * are written to and read back from files in the page cache, then echoed over
+ * loopback tcp connections. Run it with fixed or iovec as the first argument
+ * to compare the throughput with and without \ref ::ark::registered_buffer.
+ */
+
+/*!
+ * \example coro_splice_proxy.cpp
+ *
+ * This is a tcp proxy, implemented using coroutines. Each connection is
+ * relayed to the upstream server given on the command line with \ref
+ * ::ark::net::tcp::coro::relay, so that the bytes never enter user space.
+ */
+
+/*!
+ * \example coro_relay_bench.cpp
+ *
+ * This is a benchmark of \ref ::ark::net::tcp::coro::relay. Clients send
+ * through a proxy to a sink over loopback tcp connections. Run it with splice
+ * or copy as the first argument to compare the throughput of the relay with
+ * that of a read / write loop through a buffer.
  */
 
 /*!
@@ -80,9 +133,22 @@
  * - \ref coro_echo_server.cpp
  * - \ref async_echo_server.cpp
  * - \ref sync_echo_server.cpp
+ * - \ref coro_pool_echo_server.cpp
  *
  * The echo server is a tcp server which send back everything it received. These
- * examples demonstrate how network io is performed with arkio.
+ * examples demonstrate how network io is performed with arkio. The last one
+ * shows how to make use of multiple cores with \ref ::ark::async_context_pool.
+ *
+ * \section proxy tcp proxy
+ *
+ * - \ref coro_splice_proxy.cpp
+ *
+ * \section benchmarks benchmarks
+ *
+ * - \ref coro_skewed_echo_bench.cpp
+ * - \ref coro_ring_setup_bench.cpp
+ * - \ref coro_fixed_buffer_bench.cpp
+ * - \ref coro_relay_bench.cpp
  *
  * \section cat_utility cat utility
  *
@@ -130,8 +196,7 @@
  * - much simpler async_context, comparing to io_context/executors, no scheduler
  * nor executor indeed.
  * - support for general fd io, not only networking
- * - cancellations not supported (linux kernel support for cancellations is
- * buggy)
+ * - cancellation by operation handle or by fd, see \ref ::ark::async::cancel
  * ...
  *
  * In addition, some parts of this library is coded 100% compatible to the
@@ -11,4 +11,5 @@
 #include <ark/coroutine/awaitable_op.hpp>
 #include <ark/coroutine/co_async.hpp>
 #include <ark/coroutine/fire_and_forget.hpp>
+#include <ark/coroutine/scheduler.hpp>
 #include <ark/coroutine/task.hpp>
@@ -5,6 +5,7 @@
 #include <ark/bindings.hpp>
 
 #include <ark/async.hpp>
+#include <ark/coroutine/scheduler.hpp>
 
 namespace ark {
 
@@ -20,7 +21,8 @@ public:
   void await_suspend(coroutine_handle<void> ch) noexcept {
     invoke([ch, this](Ret ret) mutable {
       this->ret_.emplace(move(ret));
-      ch.resume();
+      if (!work_stealing_scheduler::try_post_ready(ch))
+        ch.resume();
     });
   }
 
@@ -39,7 +41,8 @@ public:
   void await_suspend(coroutine_handle<void> ch) noexcept {
     invoke([ch, this]() mutable {
       ready = true;
-      ch.resume();
+      if (!work_stealing_scheduler::try_post_ready(ch))
+        ch.resume();
     });
   }
 
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async/context_pool.hpp>
+#include <ark/coroutine/fire_and_forget.hpp>
+#include <ark/coroutine/task.hpp>
+#include <ark/misc/work_stealing_deque.hpp>
+
+namespace ark {
+
+/*! \addtogroup coroutine
+ *  @{
+ */
+
+/*!
+ * \brief resumes coroutines on the threads of an \ref ::ark::async_context_pool
+ * with work stealing
+ *
+ * Without a scheduler, a coroutine awaiting an io operation is resumed inline
+ * by the context the io object is bound to, so a few busy connections could
+ * saturate one core while the other contexts of the pool idle.
+ *
+ * Once a scheduler is attached to the pool, coroutines which are ready to be
+ * resumed on one of its threads are pushed into a local run queue of that
+ * thread instead. Each thread runs its own queue before waiting for io
+ * completions, and steals from the others when its queue drained. Thus
+ * coroutines migrate between threads freely, while io operations are still
+ * submitted to, and completed by, the context the io object is bound to.
+ *
+ * Coroutines started on other threads, e.g. by spawn() from main(), are
+ * distributed through a shared queue.
+ *
+ * \code
+ * async_context_pool pool;
+ * TryX(pool.init());
+ * work_stealing_scheduler sched{pool};
+ * sched.init();
+ * sched.spawn(some_task(...));
+ * TryX(pool.run());
+ * \endcode
+ *
+ * \remark coroutines resumed through the scheduler may run on any thread of
+ * the pool, accessing shared data from them requires synchronization
+ */
+class work_stealing_scheduler {
+private:
+  /*! \cond HIDDEN_CLASSES */
+
+  static const constexpr unsigned run_batch = 64;
+
+  struct worker {
+    work_stealing_scheduler &sched_;
+    async_context &ctx_;
+    size_t index_;
+    work_stealing_deque<void *> local_;
+    atomic<bool> sleeping_{false};
+    size_t next_victim_;
+
+    worker(work_stealing_scheduler &sched, async_context &ctx,
+           size_t index) noexcept
+        : sched_(sched), ctx_(ctx), index_(index), next_victim_(index + 1) {}
+
+    void *steal() noexcept {
+      auto &workers = sched_.workers_;
+      for (size_t n = 1; n < workers.size(); n++) {
+        size_t victim = next_victim_++ % workers.size();
+        if (victim == index_)
+          continue;
+        void *p = workers[victim]->local_.steal();
+        if (p != nullptr)
+          return p;
+      }
+      return nullptr;
+    }
+
+    void *next() noexcept {
+      void *p = local_.pop();
+      if (p == nullptr)
+        p = sched_.take_injected();
+      if (p == nullptr)
+        p = steal();
+      return p;
+    }
+
+    // the idle handler of ctx_
+    bool run_ready() noexcept {
+      current_ = this;
+      // woken by an io completion rather than by notify()
+      if (sleeping_.exchange(false))
+        sched_.sleepers_.fetch_sub(1);
+      for (unsigned n = 0; n < run_batch; n++) {
+        void *p = next();
+        if (p == nullptr)
+          break;
+        coroutine_handle<void>::from_address(p).resume();
+      }
+      if (!local_.empty())
+        return true;
+
+      sleeping_.store(true);
+      sched_.sleepers_.fetch_add(1);
+      atomic_thread_fence(memory_order_seq_cst);
+      // work pushed before we announced sleeping won't wake us up
+      if (sched_.has_work() && sleeping_.exchange(false)) {
+        sched_.sleepers_.fetch_sub(1);
+        return true;
+      }
+      return false;
+    }
+  };
+
+  /*! \endcond */
+
+  async_context_pool &pool_;
+  vector<unique_ptr<worker>> workers_;
+
+  mutex m_injected_;
+  vector<void *> injected_;
+  atomic<size_t> injected_size_{0};
+
+  atomic<size_t> sleepers_{0};
+
+  static inline thread_local worker *current_ = nullptr;
+
+  void *take_injected() noexcept {
+    if (injected_size_.load(memory_order_relaxed) == 0)
+      return nullptr;
+    lock_guard<mutex> g_injected(m_injected_);
+    if (injected_.empty())
+      return nullptr;
+    void *p = injected_.back();
+    injected_.pop_back();
+    injected_size_.store(injected_.size(), memory_order_relaxed);
+    return p;
+  }
+
+  void inject(void *p) noexcept {
+    lock_guard<mutex> g_injected(m_injected_);
+    injected_.push_back(p);
+    injected_size_.store(injected_.size(), memory_order_relaxed);
+  }
+
+  bool has_work() const noexcept {
+    if (injected_size_.load(memory_order_relaxed) != 0)
+      return true;
+    for (auto &w : workers_) {
+      if (!w->local_.empty())
+        return true;
+    }
+    return false;
+  }
+
+  void notify() noexcept {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (sleepers_.load() == 0)
+      return;
+    for (auto &w : workers_) {
+      if (w->sleeping_.load() && w->sleeping_.exchange(false)) {
+        sleepers_.fetch_sub(1);
+        static_cast<void>(w->ctx_.wake());
+        return;
+      }
+    }
+  }
+
+public:
+  /*!
+   * \brief constructs a scheduler for the given pool
+   *
+   * \pre the pool must have been inited. The scheduler must outlive the
+   * threads of the pool, i.e. the pool must be joined before destroying it
+   */
+  work_stealing_scheduler(async_context_pool &pool) noexcept : pool_(pool) {}
+
+  /*!
+   * \brief attach the scheduler to every context of the pool
+   *
+   * \pre must be called before the pool's run()
+   */
+  void init() noexcept {
+    Expects(workers_.empty());
+    for (size_t i = 0; i < pool_.size(); i++) {
+      workers_.emplace_back(make_unique<worker>(*this, pool_.at(i), i));
+    }
+    for (auto &w : workers_) {
+      w->ctx_.set_idle_handler(
+          [p_w = w.get()]() { return p_w->run_ready(); });
+    }
+  }
+
+  /*!
+   * \brief queue a suspended coroutine to be resumed by the scheduler
+   *
+   * could be called from any thread. If called from a thread of the pool, the
+   * coroutine goes to the local run queue of that thread.
+   */
+  void post(coroutine_handle<void> ch) noexcept {
+    worker *w = current_;
+    if (w == nullptr || addressof(w->sched_) != this ||
+        !w->local_.push(ch.address()))
+      inject(ch.address());
+    notify();
+  }
+
+  /*!
+   * \brief returns an Awaitable which moves the awaiting coroutine onto the
+   * scheduler
+   */
+  auto schedule() noexcept {
+    struct awaiter {
+      work_stealing_scheduler &sched_;
+      bool await_ready() noexcept { return false; }
+      void await_suspend(coroutine_handle<void> ch) noexcept {
+        sched_.post(ch);
+      }
+      void await_resume() noexcept {}
+    };
+    return awaiter{*this};
+  }
+
+  /*!
+   * \brief start the task on the scheduler
+   *
+   * same as co_async, except that the task starts running on one of the
+   * threads of the pool rather than the calling thread
+   */
+  template <typename T> future<T> spawn(task<T> tsk) noexcept {
+    promise<T> prom_;
+    auto fut = prom_.get_future();
+    ([](work_stealing_scheduler &sched, promise<T> prom_,
+        task<T> tsk) mutable -> fire_and_forget {
+      co_await sched.schedule();
+      if constexpr (is_void_v<T>) {
+        co_await move(tsk);
+        prom_.set_value();
+      } else {
+        prom_.set_value(co_await move(tsk));
+      }
+    })(*this, move(prom_), move(tsk));
+    return fut;
+  }
+
+  /*! \cond HIDDEN_CLASSES */
+
+  // called on completion of awaitable_op, queue the coroutine on the local run
+  // queue if running on a scheduled thread, otherwise the caller resumes it
+  static bool try_post_ready(coroutine_handle<void> ch) noexcept {
+    worker *w = current_;
+    if (w == nullptr)
+      return false;
+    w->sched_.post(ch);
+    return true;
+  }
+
+  /*! \endcond */
+
+  work_stealing_scheduler(work_stealing_scheduler &&) = delete;
+  work_stealing_scheduler &operator=(work_stealing_scheduler &&) = delete;
+  work_stealing_scheduler(const work_stealing_scheduler &) = delete;
+  work_stealing_scheduler &operator=(const work_stealing_scheduler &) = delete;
+};
+
+/*! @} */
+
+} // namespace ark
@@ -15,6 +15,11 @@ namespace ark {
  * \brief wraps fildes created by pipe2(2) as an io object
  */
 class pipe_fd : public fd {
+public:
+  /*! \cond HIDDEN_CLASSES */
+  static constexpr bool pipe_end = true;
+  /*! \endcond */
+
 protected:
   /*!
    * \brief constructs from int fildes
@@ -21,9 +21,12 @@
  */
 
 #include <ark/io/async.hpp>
+#include <ark/io/chain.hpp>
 #include <ark/io/completion_condition.hpp>
 #include <ark/io/concepts.hpp>
 #include <ark/io/fd.hpp>
+#include <ark/io/leased_buffer.hpp>
+#include <ark/io/registered_buffer.hpp>
 #include <ark/io/sync.hpp>
 
 #ifndef ARK_NO_COROUTINES
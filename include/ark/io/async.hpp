@@ -3,10 +3,12 @@
 #include <ark/async.hpp>
 #include <ark/bindings.hpp>
 #include <ark/buffer.hpp>
+#include <ark/io/chain.hpp>
 #include <ark/io/completion_condition.hpp>
 #include <ark/io/concepts.hpp>
 #include <ark/io/fd.hpp>
 #include <ark/io/iovecs.hpp>
+#include <ark/io/leased_buffer.hpp>
 
 namespace ark {
 
@@ -14,6 +16,40 @@ namespace ark {
  *  @{
  */
 
+/*!
+ * \brief the sqe a multishot operation keeps armed in the kernel, which
+ * follows it as it is re-armed, so that it alone could be cancelled, see
+ * \ref ::ark::async::cancel(multishot_handle &)
+ */
+class multishot_handle {
+private:
+  async_context &ctx_;
+  atomic<async_context::token_t> token_{0};
+  atomic<bool> cancelled_{false};
+
+public:
+  /*! \cond HIDDEN_CLASSES */
+
+  multishot_handle(async_context &ctx) noexcept : ctx_(ctx) {}
+
+  // called with the token of each sqe armed, which is cancelled right away
+  // if cancel() raced with the re-arming
+  void armed(async_context::token_t token) noexcept {
+    token_.store(token);
+    if (cancelled_.load())
+      static_cast<void>(ctx_.cancel(token));
+  }
+
+  bool cancelled() const noexcept { return cancelled_.load(); }
+
+  result<void> cancel() noexcept {
+    cancelled_.store(true);
+    return ctx_.cancel(token_.load());
+  }
+
+  /*! \endcond */
+};
+
 namespace async {
 
 /*! \cond HIDDEN_CLASSES */
@@ -47,6 +83,12 @@ struct async_io_impl {
     CompletionCondition cond_;
     size_t done_sz_;
     vector<clinux::iovec> iov_;
+    // being absolute, it carries the remaining budget across partial
+    // transfers
+    optional<op_deadline> deadline_;
+    // for zero copy sends, read by the kernel till completion
+    clinux::msghdr msg_{};
+    bool zerocopy_{false};
 
     locals_t(Fd &f, buffer_ref_type b, CompletionCondition cond) noexcept
         : f_(f), b_(b), cond_(cond), done_sz_(0) {
@@ -68,30 +110,125 @@ struct async_io_impl {
                         back_inserter(op.locals_->iov_));
 
     auto &ctx = op.ctx_;
-    auto f_get = op.locals_->f_.get();
+    auto f_get = sqe_file_of(op.locals_->f_);
     auto iov_d = op.locals_->iov_.data();
     auto iov_s = op.locals_->iov_.size();
     clinux::off_t off = 0;
     if constexpr (concepts::Seekable<Fd>) {
       off = op.locals_->f_.offset();
     }
-    if constexpr (is_same_v<IoOperation, io_operation::read>) {
-      auto ret = async_syscall::readv(ctx, f_get, iov_d, iov_s, off,
-                                      op.yield_syscall(go_on));
-      if (!ret)
-        op.complete(ret.error());
-    } else if constexpr (is_same_v<IoOperation, io_operation::write>) {
-      auto ret = async_syscall::writev(ctx, f_get, iov_d, iov_s, off,
-                                       op.yield_syscall(go_on));
+    auto &deadline = op.locals_->deadline_;
+    auto ts = deadline ? addressof(deadline->ts_) : nullptr;
+    if constexpr (is_same_v<IoOperation, io_operation::write> &&
+                  concepts::internal::StreamSocket<Fd>) {
+      size_t left = buffer_size(op.locals_->b_) - op.locals_->done_sz_;
+      op.locals_->zerocopy_ =
+          ts == nullptr && ctx.use_zerocopy(min(left, to_transfer_max));
+      if (op.locals_->zerocopy_) {
+        auto ret = start_zerocopy(op, f_get);
+        if (!ret)
+          op.complete(ret.error());
+        return;
+      }
+    }
+    // a single buffer lying in the registered buffer pool saves the kernel
+    // pinning and mapping its pages on each operation
+    int buf_index = -1;
+    if (iov_s == 1)
+      buf_index = ctx.buffer_index(iov_d->iov_base, iov_d->iov_len);
+    auto ret = start_syscall(ctx, f_get, iov_d, iov_s, off, buf_index, ts,
+                             op.yield_syscall(go_on));
+    if (!ret)
+      op.complete(ret.error());
+  }
+
+  // the kernel completes a zero copy send with the result, then with a
+  // notification once it no longer reads from the buffers, which is when the
+  // write goes on
+  static result<void> start_zerocopy(op_t &op,
+                                     io_uring_async::sqe_file f) noexcept {
+    auto &ctx = op.ctx_;
+    auto &msg = op.locals_->msg_;
+    msg = {};
+    msg.msg_iov = op.locals_->iov_.data();
+    msg.msg_iovlen = op.locals_->iov_.size();
+    auto ret = async_syscall::sendmsg_zc(
+        ctx, f, addressof(msg), 0,
+        [&ctx, cb = op.yield_syscall(go_on),
+         sent = optional<result<long>>{}](result<long> ret,
+                                          bool more) mutable {
+          if (ctx.cqe_flags() & IORING_CQE_F_NOTIF)
+            return cb(sent ? move(*sent) : move(ret));
+          // no notification follows
+          if (!more)
+            return cb(move(ret));
+          sent = move(ret);
+        });
+    if (!ret)
+      return ret.as_failure();
+    return success();
+  }
+
+  // readv / writev, or READ_FIXED / WRITE_FIXED with buf_index != -1, linked
+  // to a timeout if ts is not null
+  static result<void> start_syscall(async_context &ctx,
+                                    io_uring_async::sqe_file f,
+                                    const clinux::iovec *iov_d, size_t iov_s,
+                                    clinux::off_t off, int buf_index,
+                                    clinux::__kernel_timespec *ts,
+                                    syscall_callback_t &&cb) noexcept {
+    constexpr bool is_read = is_same_v<IoOperation, io_operation::read>;
+    if (buf_index != -1) {
+      auto buf = iov_d->iov_base;
+      auto len = static_cast<unsigned>(iov_d->iov_len);
+      if (ts != nullptr) {
+        if constexpr (is_read)
+          return async_syscall::read_fixed(ctx, f, buf, len, off, buf_index,
+                                           ts, move(cb));
+        else
+          return async_syscall::write_fixed(ctx, f, buf, len, off, buf_index,
+                                            ts, move(cb));
+      }
+      auto ret = is_read ? async_syscall::read_fixed(ctx, f, buf, len, off,
+                                                     buf_index, move(cb))
+                         : async_syscall::write_fixed(ctx, f, buf, len, off,
+                                                      buf_index, move(cb));
       if (!ret)
-        op.complete(ret.error());
+        return ret.as_failure();
+      return success();
     }
+    if (ts != nullptr) {
+      if constexpr (is_read)
+        return async_syscall::readv(ctx, f, iov_d, iov_s, off, ts, move(cb));
+      else
+        return async_syscall::writev(ctx, f, iov_d, iov_s, off, ts, move(cb));
+    }
+    auto ret = is_read ? async_syscall::readv(ctx, f, iov_d, iov_s, off,
+                                              move(cb))
+                       : async_syscall::writev(ctx, f, iov_d, iov_s, off,
+                                               move(cb));
+    if (!ret)
+      return ret.as_failure();
+    return success();
   }
 
   static void go_on(op_t &op, result<long> ret) noexcept {
+    if (op.locals_->deadline_)
+      ret = op.locals_->deadline_->translate(move(ret));
+    if (!ret && op.locals_->zerocopy_) {
+      auto ev = ret.error().value();
+      // kernels before 6.1, or sockets not supporting it
+      if (ev == EINVAL || ev == EOPNOTSUPP) {
+        op.ctx_.disable_zerocopy();
+        return run(op);
+      }
+    }
     if (!ret) {
       return op.complete(ret.error());
     }
+    if constexpr (concepts::internal::IdleTimed<Fd>) {
+      op.locals_->f_.refresh_idle_timeout();
+    }
     size_t ret_sz = static_cast<size_t>(ret.value());
     if constexpr (is_same_v<IoOperation, io_operation::read>) {
       if (ret_sz == 0) { // eof
@@ -126,6 +263,31 @@ inline void read(Fd &f, const MutableBufferSequence &b,
       .run();
 }
 
+/*!
+ * \brief read from fd to buffer until eof or completion condition is met,
+ * failing once deadline is reached.
+ *
+ * returns instantly, cb is invoked on completion or error. Each read syscall is
+ * linked to a timeout in the kernel, so that no extra wakeup is needed to
+ * enforce the deadline. Once reached, cb gets errc::timed_out, even if some of
+ * the bytes have been read.
+ */
+template <concepts::Fd Fd,
+          concepts::MutableBufferSequence MutableBufferSequence,
+          concepts::CompletionCondition CompletionCondition>
+inline void read(Fd &f, const MutableBufferSequence &b,
+                 CompletionCondition cond,
+                 chrono::steady_clock::time_point deadline,
+                 callback<result<size_t>> &&cb) noexcept {
+  using impl_t = async_io_impl<io_operation::read, Fd, MutableBufferSequence,
+                               CompletionCondition>;
+  auto locals = make_unique<typename impl_t::locals_t>(f, b, cond);
+  locals->deadline_.emplace(deadline);
+  async_op<impl_t>(f.context(), forward<callback<result<size_t>>>(cb),
+                   move(locals))
+      .run();
+}
+
 /*!
  * \brief read from fd to buffer until eof or completion condition is met.
  *
@@ -155,6 +317,29 @@ inline void write(Fd &f, const ConstBufferSequence &b, CompletionCondition cond,
       .run();
 }
 
+/*!
+ * \brief write to fd from buffer until completion condition is met, failing
+ * once deadline is reached.
+ *
+ * returns instantly, cb is invoked on completion or error. Each write syscall
+ * is linked to a timeout in the kernel, so that no extra wakeup is needed to
+ * enforce the deadline. Once reached, cb gets errc::timed_out, even if some of
+ * the bytes have been written.
+ */
+template <concepts::Fd Fd, concepts::ConstBufferSequence ConstBufferSequence,
+          concepts::CompletionCondition CompletionCondition>
+inline void write(Fd &f, const ConstBufferSequence &b, CompletionCondition cond,
+                  chrono::steady_clock::time_point deadline,
+                  callback<result<size_t>> &&cb) noexcept {
+  using impl_t = async_io_impl<io_operation::write, Fd, ConstBufferSequence,
+                               CompletionCondition>;
+  auto locals = make_unique<typename impl_t::locals_t>(f, b, cond);
+  locals->deadline_.emplace(deadline);
+  async_op<impl_t>(f.context(), forward<callback<result<size_t>>>(cb),
+                   move(locals))
+      .run();
+}
+
 /*!
  * \brief write to fd from buffer until completion condition is met.
  *
@@ -167,6 +352,370 @@ inline void write(Fd &f, const ConstBufferSequence &b,
   write(f, b, transfer_all(), forward<callback<result<size_t>>>(cb));
 }
 
+/*!
+ * \brief read some bytes from fd into a buffer picked from the provided buffer
+ * ring of the bound context.
+ *
+ * returns instantly, cb is invoked on completion or error. Unlike read(), no
+ * buffer is tied up while waiting, the kernel only takes one from the ring
+ * once data arrives, so that idle connections cost no buffer memory. The
+ * buffer is empty on eof, and fails with ENOBUFS if the ring is exhausted or
+ * not set up, see \ref ::ark::async_context_options::provided_buffers.
+ *
+ * requires kernel >= 5.19
+ */
+template <concepts::Fd Fd>
+inline void read_some(Fd &f, callback<result<leased_buffer>> &&cb) noexcept {
+  auto &ctx = f.context();
+  if (!ctx.has_provided_buffers())
+    return cb(as_ec(ENOBUFS));
+  clinux::off_t off = 0;
+  if constexpr (concepts::Seekable<Fd>) {
+    off = f.offset();
+  }
+  auto ret = async_syscall::read_select(
+      ctx, sqe_file_of(f), off, async_context::provided_buffer_group,
+      [&f, cb(forward<callback<result<leased_buffer>>>(cb))](
+          result<long> ret) mutable {
+        if (!ret)
+          return cb(ret.error());
+        auto sz = static_cast<size_t>(ret.value());
+        auto b = take_selected_buffer(f.context(), sz);
+        if constexpr (concepts::Seekable<Fd>) {
+          f.feed(sz);
+        }
+        if constexpr (concepts::internal::IdleTimed<Fd>) {
+          f.refresh_idle_timeout();
+        }
+        cb(move(b));
+      });
+  if (!ret)
+    cb(ret.error());
+}
+
+/*! \cond HIDDEN_CLASSES */
+
+// the offset a splice on f starts from, -1 for the non seekable ones
+template <concepts::Fd Fd> inline int64_t splice_offset(Fd &f) noexcept {
+  if constexpr (concepts::Seekable<Fd>) {
+    return f.offset();
+  }
+  return -1;
+}
+
+// bookkeeping of io objects after sz bytes got spliced from or to f
+template <concepts::Fd Fd> inline void spliced(Fd &f, size_t sz) noexcept {
+  if constexpr (concepts::Seekable<Fd>) {
+    f.feed(sz);
+  }
+  if constexpr (concepts::internal::IdleTimed<Fd>) {
+    f.refresh_idle_timeout();
+  }
+}
+
+template <concepts::Fd From, concepts::Fd To> struct async_splice_impl {
+  // if neither end is a pipe, the bytes go through one from the pool
+  static constexpr bool through_pipe =
+      !concepts::internal::Pipe<From> && !concepts::internal::Pipe<To>;
+
+  struct locals_t {
+    From &from_;
+    To &to_;
+    size_t sz_;
+    // the offset of from_ on start, as it is only advanced by the bytes
+    // which made it to to_
+    int64_t from_off_;
+    // spliced from from_, either into the pipe or right to to_
+    size_t read_sz_{0};
+    // spliced to to_, the bytes in between are left in the pipe
+    size_t done_sz_{0};
+    size_t drain_sz_{0};
+    size_t chunk_sz_{0};
+    bool eof_{false};
+    io_uring_async::kernel_pipe p_;
+    result<long> drain_ret_{as_ec(ECANCELED)};
+    result<long> read_ret_{as_ec(ECANCELED)};
+
+    locals_t(From &from, To &to, size_t sz) noexcept
+        : from_(from), to_(to), sz_(sz), from_off_(splice_offset(from)) {}
+
+    int64_t read_off() const noexcept {
+      return from_off_ == -1 ? -1
+                             : from_off_ + static_cast<int64_t>(read_sz_);
+    }
+
+    // tells a socket that more is to come, as MSG_MORE
+    unsigned out_flags(size_t sz) const noexcept {
+      return done_sz_ + sz < sz_ && !eof_ ? SPLICE_F_MORE : 0;
+    }
+
+    // sz more bytes made it to to_
+    void delivered(size_t sz) noexcept {
+      spliced(from_, sz);
+      spliced(to_, sz);
+      done_sz_ += sz;
+    }
+  };
+  using ret_t = result<size_t>;
+  using op_t = async_op<async_splice_impl<From, To>>;
+
+  // a single splice moves up to the size of the pipe
+  static unsigned chunk(size_t sz, size_t limit) noexcept {
+    return static_cast<unsigned>(
+        min({sz, limit, size_t{numeric_limits<int>::max()}}));
+  }
+
+  static void finish(op_t &op, result<size_t> ret) noexcept {
+    if constexpr (through_pipe) {
+      auto &l = *op.locals_;
+      op.ctx_.release_pipe(move(l.p_), ret && l.read_sz_ == l.done_sz_);
+    }
+    op.complete(move(ret));
+  }
+
+  static void run(op_t &op) noexcept {
+    auto &l = *op.locals_;
+    auto &ctx = op.ctx_;
+    auto from = sqe_file_of(l.from_);
+    auto to = sqe_file_of(l.to_);
+    if constexpr (through_pipe) {
+      if (l.p_.rd_ == -1) {
+        auto p = ctx.acquire_pipe();
+        if (!p)
+          return op.complete(p.error());
+        l.p_ = move(p).value();
+      }
+      // what a broken link left in the pipe goes first
+      l.drain_sz_ = chunk(l.read_sz_ - l.done_sz_, l.p_.size_);
+      if (l.eof_ || l.read_sz_ == l.sz_) {
+        if (l.drain_sz_ == 0)
+          return finish(op, l.done_sz_);
+        auto ret = async_syscall::splice(
+            ctx, l.p_.rd_, -1, to, splice_offset(l.to_), l.drain_sz_, 0,
+            op.yield_syscall(go_on_drained));
+        if (!ret)
+          finish(op, ret.error());
+        return;
+      }
+      // or else it is linked in front of the next pair
+      l.chunk_sz_ = chunk(l.sz_ - l.read_sz_, l.p_.size_);
+      l.drain_ret_ = as_ec(ECANCELED);
+      l.read_ret_ = as_ec(ECANCELED);
+      auto *p_l = op.locals_.get();
+      auto ret = async_syscall::splice_through(
+          ctx, from, l.read_off(), l.p_.wr_, l.p_.rd_, to,
+          splice_offset(l.to_), static_cast<unsigned>(l.drain_sz_),
+          static_cast<unsigned>(l.chunk_sz_),
+          l.out_flags(l.drain_sz_ + l.chunk_sz_),
+          [p_l](result<long> ret) { p_l->drain_ret_ = move(ret); },
+          [p_l](result<long> ret) { p_l->read_ret_ = move(ret); },
+          op.yield_syscall(go_on_linked));
+      if (!ret)
+        finish(op, ret.error());
+    } else {
+      if (l.eof_ || l.done_sz_ == l.sz_)
+        return finish(op, l.done_sz_);
+      auto ret = async_syscall::splice(
+          ctx, from, l.read_off(), to, splice_offset(l.to_),
+          chunk(l.sz_ - l.done_sz_, l.sz_), 0, op.yield_syscall(go_on));
+      if (!ret)
+        finish(op, ret.error());
+    }
+  }
+
+  // a splice from a pipe end, or to one
+  static void go_on(op_t &op, result<long> ret) noexcept {
+    auto &l = *op.locals_;
+    if (!ret)
+      return finish(op, ret.error());
+    auto sz = static_cast<size_t>(ret.value());
+    if (sz == 0) { // eof
+      l.eof_ = true;
+      return run(op);
+    }
+    l.read_sz_ += sz;
+    l.delivered(sz);
+    run(op);
+  }
+
+  // the linked pair, the first half of which stored its result in read_ret_,
+  // after the drain, if any, which stored its result in drain_ret_
+  static void go_on_linked(op_t &op, result<long> ret) noexcept {
+    auto &l = *op.locals_;
+    if (l.drain_sz_ != 0) {
+      if (!l.drain_ret_)
+        return finish(op, l.drain_ret_.error());
+      auto drained = static_cast<size_t>(l.drain_ret_.value());
+      l.delivered(drained);
+      // the pair got cancelled
+      if (drained < l.drain_sz_)
+        return run(op);
+    }
+    if (!l.read_ret_)
+      return finish(op, l.read_ret_.error());
+    auto read_sz = static_cast<size_t>(l.read_ret_.value());
+    if (read_sz == 0)
+      l.eof_ = true;
+    l.read_sz_ += read_sz;
+    if (!ret) {
+      // the link is broken by a short first half, leaving it in the pipe
+      bool broken = ret.error().value() == ECANCELED && read_sz < l.chunk_sz_;
+      if (!broken)
+        return finish(op, ret.error());
+      return run(op);
+    }
+    l.delivered(static_cast<size_t>(ret.value()));
+    run(op);
+  }
+
+  // a splice out of the pipe, of what a broken link left, once nothing more
+  // is to be read
+  static void go_on_drained(op_t &op, result<long> ret) noexcept {
+    auto &l = *op.locals_;
+    if (!ret)
+      return finish(op, ret.error());
+    l.delivered(static_cast<size_t>(ret.value()));
+    run(op);
+  }
+};
+
+/*! \endcond */
+
+/*!
+ * \brief moves up to sz bytes from one io object to another, without copying
+ * them to user space, until eof.
+ *
+ * returns instantly, cb is invoked on completion or error, with the number of
+ * bytes moved to the destination. Done with IORING_OP_SPLICE, either right
+ * between them if any of them is a \ref ::ark::pipe_fd, or else through a
+ * pipe taken from the pool of the bound context, as the kernel only splices
+ * to or from pipes. In that case each chunk, up to the size of the pipe, is
+ * moved by a splice into the pipe linked to one out of it, so that no round
+ * trip to user space is needed in between, see \ref
+ * ::ark::async_context_options::pipes.
+ *
+ * the offsets of seekable io objects are used, and advanced by the bytes
+ * which made it to the destination, so that after an error a seekable source
+ * could be spliced again from where it stopped. Requires kernel >= 5.7, both
+ * must be bound to the same context.
+ */
+template <concepts::Fd From, concepts::Fd To>
+inline void splice(From &from, To &to, size_t sz,
+                   callback<result<size_t>> &&cb) noexcept {
+  using impl_t = async_splice_impl<From, To>;
+  async_op<impl_t>(from.context(), forward<callback<result<size_t>>>(cb),
+                   make_unique<typename impl_t::locals_t>(from, to, sz))
+      .run();
+}
+
+/*!
+ * \brief duplicates up to sz bytes from one pipe to another, leaving them in
+ * the source pipe, as tee(2).
+ *
+ * returns instantly, cb is invoked on completion or error, with the number of
+ * bytes duplicated, which is done with a single IORING_OP_TEE, so it might be
+ * less than sz. 0 if the source pipe is empty and its write end closed.
+ * Requires kernel >= 5.8.
+ */
+template <concepts::Fd From, concepts::Fd To>
+requires concepts::internal::Pipe<From> && concepts::internal::Pipe<To>
+inline void tee(From &from, To &to, size_t sz,
+                callback<result<size_t>> &&cb) noexcept {
+  auto ret = async_syscall::tee(
+      from.context(), sqe_file_of(from), sqe_file_of(to),
+      static_cast<unsigned>(min(sz, size_t{numeric_limits<int>::max()})),
+      [cb(forward<callback<result<size_t>>>(cb))](result<long> ret) mutable {
+        if (!ret)
+          return cb(ret.error());
+        cb(static_cast<size_t>(ret.value()));
+      });
+  if (!ret)
+    cb(ret.error());
+}
+
+/*! \cond HIDDEN_CLASSES */
+
+struct chain_state {
+  chain c_;
+  chain::results_type results_;
+  size_t remaining_;
+  callback<result<chain::results_type>> cb_;
+
+  chain_state(chain &&c, callback<result<chain::results_type>> &&cb) noexcept
+      : c_(move(c)), results_(c_.size(), as_ec(ECANCELED)),
+        remaining_(c_.size()),
+        cb_(forward<callback<result<chain::results_type>>>(cb)) {}
+};
+
+/*! \endcond */
+
+/*!
+ * \brief submit all the links of a chain at once, see \ref ::ark::chain
+ *
+ * returns instantly, cb is invoked once every link completed, with the result
+ * of each link, or with the error if the chain could not be submitted.
+ */
+inline void submit(chain &&c,
+                   callback<result<chain::results_type>> &&cb) noexcept {
+  if (c.size() == 0)
+    return cb(as_ec(EINVAL));
+  auto &ctx = c.context();
+  // owned by the callbacks, released by the last completion
+  auto state = make_unique<chain_state>(
+      move(c), forward<callback<result<chain::results_type>>>(cb));
+  auto *p_state = state.release();
+  vector<async_context::callback_t> callbacks;
+  callbacks.reserve(p_state->c_.size());
+  for (size_t i = 0; i < p_state->c_.size(); i++) {
+    callbacks.emplace_back([p_state, i](result<long> ret) {
+      if (ret)
+        p_state->results_[i] = static_cast<size_t>(ret.value());
+      else
+        p_state->results_[i] = ret.error();
+      if (--p_state->remaining_ != 0)
+        return;
+      unique_ptr<chain_state> state{p_state};
+      state->cb_(move(state->results_));
+    });
+  }
+  auto ret = ctx.add_sqe_chain(
+      [p_state](chain::sqe_ref sqe, size_t i) { p_state->c_.prep(sqe, i); },
+      callbacks);
+  if (ret.has_error()) {
+    unique_ptr<chain_state> state{p_state};
+    state->cb_(ret.as_failure());
+  }
+}
+
+/*!
+ * \brief cancel the multishot operation the handle was returned for
+ *
+ * returns instantly, unlike \ref cancel(Fd &) the other operations in flight
+ * on the io object are left untouched. The callback of the operation is
+ * invoked for the last time with ECANCELED, unless it ended in the meantime.
+ */
+inline result<void> cancel(multishot_handle &h) noexcept { return h.cancel(); }
+
+/*!
+ * \brief cancel all the io operations in flight on the fd
+ *
+ * returns instantly. The callbacks of the cancelled operations are still
+ * invoked, with ECANCELED as the error, unless they completed in the meantime.
+ * The buffers are no longer accessed by the kernel once the callbacks are
+ * invoked. Coroutines awaiting the operations are resumed likewise.
+ *
+ * requires linux kernel >= 5.19, on older kernels the operations are left
+ * untouched.
+ *
+ * \pre f must be bound to an async_context
+ */
+template <concepts::Fd Fd> inline result<void> cancel(Fd &f) noexcept {
+  // lets the multishot operations waiting to be re-armed know
+  if constexpr (requires { f.count_cancel(); })
+    f.count_cancel();
+  return f.context().cancel_fd(sqe_file_of(f));
+}
+
 } // namespace async
 
 /*! @} */
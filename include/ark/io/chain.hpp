@@ -0,0 +1,147 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async.hpp>
+#include <ark/buffer.hpp>
+#include <ark/io/concepts.hpp>
+#include <ark/io/fd.hpp>
+
+namespace ark {
+
+/*! \addtogroup io
+ *  @{
+ */
+
+/*!
+ * \brief io operations linked to be run one after another by the kernel
+ *
+ * Links are appended with read(), write() or fsync(), then the chain is
+ * started as a whole with \ref ::ark::async::submit or \ref
+ * ::ark::coro::submit, which submits all of the links at once. Each link is
+ * started by the kernel only once the one before it completed, with no round
+ * trip to user space in between, e.g. a write of the header, a write of the
+ * body, then an fsync.
+ *
+ * Once a link fails, or transfers less bytes than the size of its buffer, the
+ * links after it are not started and complete with ECANCELED. Unless the link
+ * was made a hard link with hard(), after which the chain goes on regardless.
+ *
+ * The results are reported per link. Each io object must be bound to the same
+ * \ref ::ark::async_context, and must outlive the chain, as must the buffers.
+ * For seekable fds, the offset is taken, and advanced by the size of the
+ * buffer, as the link is appended.
+ *
+ * up to 16 links in a chain, submitting a longer one fails with EINVAL.
+ */
+class chain {
+public:
+  using results_type = vector<result<size_t>>;
+
+  /*! \cond HIDDEN_CLASSES */
+
+  using sqe_ref = io_uring_async::sqe_ref;
+  using prep_t = unique_function<void(sqe_ref)>;
+
+  /*! \endcond */
+
+private:
+  struct link {
+    prep_t prep_;
+    bool hard_;
+  };
+
+  async_context *ctx_{nullptr};
+  vector<link> links_;
+
+  template <concepts::Fd Fd>
+  static clinux::off_t take_offset(Fd &f, size_t sz) noexcept {
+    clinux::off_t off = 0;
+    if constexpr (concepts::Seekable<Fd>) {
+      off = f.offset();
+      f.feed(sz);
+    }
+    return off;
+  }
+
+public:
+  /*!
+   * \brief appends a link which reads from fd to buffer
+   *
+   * the link is broken if less than the size of buffer is read
+   */
+  template <concepts::Fd Fd> chain &read(Fd &f, mutable_buffer b) noexcept {
+    auto off = take_offset(f, b.size());
+    return append(f.context(), [file = sqe_file_of(f), b, off](sqe_ref sqe) {
+      sqe.prep_read(file.fd_, b.data(), static_cast<unsigned>(b.size()), off);
+      sqe.add_file_flags(file);
+    });
+  }
+
+  /*!
+   * \brief appends a link which writes to fd from buffer
+   *
+   * the link is broken if less than the size of buffer is written
+   */
+  template <concepts::Fd Fd> chain &write(Fd &f, const_buffer b) noexcept {
+    auto off = take_offset(f, b.size());
+    return append(f.context(), [file = sqe_file_of(f), b, off](sqe_ref sqe) {
+      sqe.prep_write(file.fd_, b.data(), static_cast<unsigned>(b.size()), off);
+      sqe.add_file_flags(file);
+    });
+  }
+
+  /*!
+   * \brief appends a link which flushes fd to the storage device, as fsync(2)
+   */
+  template <concepts::Fd Fd> chain &fsync(Fd &f) noexcept {
+    return append(f.context(), [file = sqe_file_of(f)](sqe_ref sqe) {
+      sqe.prep_fsync(file.fd_, 0);
+      sqe.add_file_flags(file);
+    });
+  }
+
+  /*!
+   * \brief makes the last appended link a hard link
+   *
+   * the links after a hard link are started even if it failed
+   */
+  chain &hard() noexcept {
+    Expects(!links_.empty());
+    links_.back().hard_ = true;
+    return *this;
+  }
+
+  /*!
+   * \brief returns the number of links
+   */
+  size_t size() const noexcept { return links_.size(); }
+
+  /*! \cond HIDDEN_CLASSES */
+
+  chain &append(async_context &ctx, prep_t &&prep) noexcept {
+    Expects(ctx_ == nullptr || ctx_ == &ctx);
+    ctx_ = &ctx;
+    links_.push_back({forward<prep_t>(prep), false});
+    return *this;
+  }
+
+  async_context &context() const noexcept {
+    Expects(ctx_ != nullptr);
+    return *ctx_;
+  }
+
+  // the last link is not linked to anything
+  void prep(sqe_ref sqe, size_t i) noexcept {
+    links_[i].prep_(sqe);
+    if (i + 1 == links_.size())
+      return;
+    sqe.add_flags(links_[i].hard_ ? IOSQE_IO_HARDLINK : IOSQE_IO_LINK);
+  }
+
+  /*! \endcond */
+};
+
+/*! @} */
+
+} // namespace ark
@@ -110,6 +110,17 @@ template <class T>
 concept IoOperation =
     is_same_v<T, io_operation::read> || is_same_v<T, io_operation::write>;
 
+// io objects on a connected stream socket
+template <class T> concept StreamSocket = T::stream_socket;
+
+// either end of a pipe, which could be spliced from or to directly
+template <class T> concept Pipe = T::pipe_end;
+
+// io objects with an idle timeout, re-armed on each completion
+template <class T> concept IdleTimed = requires(T f) {
+  f.refresh_idle_timeout();
+};
+
 }
 
 } // namespace concepts
@@ -27,11 +27,19 @@ struct read_awaitable : public awaitable_op<result<size_t>> {
   Fd &f_;
   const MutableBufferSequence &b_;
   CompletionCondition cond_;
+  optional<chrono::steady_clock::time_point> deadline_;
 
   read_awaitable(Fd &f, const MutableBufferSequence &b,
                  CompletionCondition cond) noexcept
       : f_(f), b_(b), cond_(cond) {}
+  read_awaitable(Fd &f, const MutableBufferSequence &b,
+                 CompletionCondition cond,
+                 chrono::steady_clock::time_point deadline) noexcept
+      : f_(f), b_(b), cond_(cond), deadline_(deadline) {}
   void invoke(callback<result<size_t>> &&cb) noexcept override {
+    if (deadline_)
+      return async::read(f_, b_, cond_, *deadline_,
+                          forward<callback<result<size_t>>>(cb));
     async::read(f_, b_, cond_, forward<callback<result<size_t>>>(cb));
   }
 };
@@ -42,15 +50,69 @@ struct write_awaitable : public awaitable_op<result<size_t>> {
   Fd &f_;
   const ConstBufferSequence &b_;
   CompletionCondition cond_;
+  optional<chrono::steady_clock::time_point> deadline_;
 
   write_awaitable(Fd &f, const ConstBufferSequence &b,
                   CompletionCondition cond) noexcept
       : f_(f), b_(b), cond_(cond) {}
+  write_awaitable(Fd &f, const ConstBufferSequence &b,
+                  CompletionCondition cond,
+                  chrono::steady_clock::time_point deadline) noexcept
+      : f_(f), b_(b), cond_(cond), deadline_(deadline) {}
   void invoke(callback<result<size_t>> &&cb) noexcept override {
+    if (deadline_)
+      return async::write(f_, b_, cond_, *deadline_,
+                          forward<callback<result<size_t>>>(cb));
     async::write(f_, b_, cond_, forward<callback<result<size_t>>>(cb));
   }
 };
 
+template <concepts::Fd Fd>
+struct read_some_awaitable : public awaitable_op<result<leased_buffer>> {
+  Fd &f_;
+
+  read_some_awaitable(Fd &f) noexcept : f_(f) {}
+  void invoke(callback<result<leased_buffer>> &&cb) noexcept override {
+    async::read_some(f_, forward<callback<result<leased_buffer>>>(cb));
+  }
+};
+
+template <concepts::Fd From, concepts::Fd To>
+struct splice_awaitable : public awaitable_op<result<size_t>> {
+  From &from_;
+  To &to_;
+  size_t sz_;
+
+  splice_awaitable(From &from, To &to, size_t sz) noexcept
+      : from_(from), to_(to), sz_(sz) {}
+  void invoke(callback<result<size_t>> &&cb) noexcept override {
+    async::splice(from_, to_, sz_, forward<callback<result<size_t>>>(cb));
+  }
+};
+
+template <concepts::Fd From, concepts::Fd To>
+struct tee_awaitable : public awaitable_op<result<size_t>> {
+  From &from_;
+  To &to_;
+  size_t sz_;
+
+  tee_awaitable(From &from, To &to, size_t sz) noexcept
+      : from_(from), to_(to), sz_(sz) {}
+  void invoke(callback<result<size_t>> &&cb) noexcept override {
+    async::tee(from_, to_, sz_, forward<callback<result<size_t>>>(cb));
+  }
+};
+
+struct submit_awaitable : public awaitable_op<result<chain::results_type>> {
+  chain c_;
+
+  submit_awaitable(chain &&c) noexcept : c_(move(c)) {}
+  void invoke(callback<result<chain::results_type>> &&cb) noexcept override {
+    async::submit(move(c_),
+                  forward<callback<result<chain::results_type>>>(cb));
+  }
+};
+
 /*! \endcond */
 
 /*!
@@ -67,6 +129,22 @@ inline auto read(Fd &f, const MutableBufferSequence &b,
   return read_awaitable(f, b, cond);
 }
 
+/*!
+ * \brief returns an Awaitable which read from fd to buffer until eof or
+ * completion condition is met, failing once deadline is reached.
+ *
+ * returns an Awaitable which yields an result<size_t> when co_awaited, which is
+ * errc::timed_out once deadline is reached, see \ref ::ark::async::read
+ */
+template <concepts::Fd Fd,
+          concepts::MutableBufferSequence MutableBufferSequence,
+          concepts::CompletionCondition CompletionCondition>
+inline auto read(Fd &f, const MutableBufferSequence &b,
+                 CompletionCondition cond,
+                 chrono::steady_clock::time_point deadline) noexcept {
+  return read_awaitable(f, b, cond, deadline);
+}
+
 /*!
  * \brief returns an Awaitable which read from fd to buffer until eof or
  * completion condition is met.
@@ -92,6 +170,20 @@ inline auto write(Fd &f, const ConstBufferSequence &b,
   return write_awaitable(f, b, cond);
 }
 
+/*!
+ * \brief returns an Awaitable which write to fd from buffer until completion
+ * condition is met, failing once deadline is reached.
+ *
+ * returns an Awaitable which yields an result<size_t> when co_awaited, which is
+ * errc::timed_out once deadline is reached, see \ref ::ark::async::write
+ */
+template <concepts::Fd Fd, concepts::ConstBufferSequence ConstBufferSequence,
+          concepts::CompletionCondition CompletionCondition>
+inline auto write(Fd &f, const ConstBufferSequence &b, CompletionCondition cond,
+                  chrono::steady_clock::time_point deadline) noexcept {
+  return write_awaitable(f, b, cond, deadline);
+}
+
 /*!
  * \brief returns an Awaitable which write to fd from buffer until completion
  * condition is met.
@@ -103,8 +195,171 @@ inline auto write(Fd &f, const ConstBufferSequence &b) noexcept {
   return write_awaitable(f, b, transfer_all());
 }
 
+/*!
+ * \brief returns an Awaitable which read some bytes from fd into a buffer
+ * picked from the provided buffer ring of the bound context.
+ *
+ * returns an Awaitable which yields an result<leased_buffer> when co_awaited,
+ * see \ref ::ark::async::read_some
+ */
+template <concepts::Fd Fd> inline auto read_some(Fd &f) noexcept {
+  return read_some_awaitable<Fd>(f);
+}
+
+/*!
+ * \brief returns an Awaitable which moves up to sz bytes from one io object to
+ * another, without copying them to user space, until eof.
+ *
+ * returns an Awaitable which yields the number of bytes moved as an
+ * result<size_t> when co_awaited, see \ref ::ark::async::splice
+ */
+template <concepts::Fd From, concepts::Fd To>
+inline auto splice(From &from, To &to, size_t sz) noexcept {
+  return splice_awaitable<From, To>(from, to, sz);
+}
+
+/*!
+ * \brief returns an Awaitable which duplicates up to sz bytes from one pipe to
+ * another, leaving them in the source pipe.
+ *
+ * returns an Awaitable which yields the number of bytes duplicated as an
+ * result<size_t> when co_awaited, see \ref ::ark::async::tee
+ */
+template <concepts::Fd From, concepts::Fd To>
+requires concepts::internal::Pipe<From> && concepts::internal::Pipe<To>
+inline auto tee(From &from, To &to, size_t sz) noexcept {
+  return tee_awaitable<From, To>(from, to, sz);
+}
+
+/*!
+ * \brief returns an Awaitable which submits all the links of a chain at once,
+ * see \ref ::ark::chain
+ *
+ * returns an Awaitable which yields the result of each link when co_awaited,
+ * once every link completed.
+ */
+inline auto submit(chain &&c) noexcept { return submit_awaitable(move(c)); }
+
 } // namespace coro
 
+/*! \cond HIDDEN_CLASSES */
+
+// the result which ends a multishot stream
+template <class T> inline bool is_stream_end(const result<T> &ret) noexcept {
+  return !ret;
+}
+
+inline bool is_stream_end(const result<leased_buffer> &ret) noexcept {
+  return !ret || ret.value().size() == 0;
+}
+
+/*! \endcond */
+
+/*!
+ * \brief the results of a multishot operation on an io object, awaited one by
+ * one
+ *
+ * The operation is started on construction, and keeps producing results in
+ * the kernel. The ones produced while none is awaited are queued in the
+ * stream. Once the operation ended, with an error or eof, next() yields that
+ * from then on. Destroying the stream cancels the operation, leaving the
+ * other ones on the io object alone. The io object must outlive the stream,
+ * and must not be moved meanwhile.
+ */
+template <concepts::Fd Fd, class T> class multishot_stream {
+public:
+  using start_t = unique_function<shared_ptr<multishot_handle>(
+      Fd &, callback<result<T>> &&)>;
+
+private:
+  // shared with the operation, which might outlive the stream
+  struct state_type {
+    mutex m_;
+    deque<result<T>> ready_;
+    callback<result<T>> waiter_;
+    bool ended_{false};
+    optional<error_code> end_ec_;
+  };
+
+  struct next_awaitable : public awaitable_op<result<T>> {
+    shared_ptr<state_type> state_;
+
+    next_awaitable(shared_ptr<state_type> state) noexcept
+        : state_(move(state)) {}
+    void invoke(callback<result<T>> &&cb) noexcept override {
+      unique_lock<mutex> g(state_->m_);
+      if (!state_->ready_.empty()) {
+        auto ret = move(state_->ready_.front());
+        state_->ready_.pop_front();
+        g.unlock();
+        return cb(move(ret));
+      }
+      if (state_->ended_) {
+        auto end_ec = state_->end_ec_;
+        g.unlock();
+        // only an eof ends it without an error
+        if constexpr (is_default_constructible_v<T>) {
+          if (!end_ec)
+            return cb(T{});
+        }
+        return cb(*end_ec);
+      }
+      state_->waiter_ = forward<callback<result<T>>>(cb);
+    }
+  };
+
+  shared_ptr<state_type> state_;
+  shared_ptr<multishot_handle> handle_;
+
+  static void push(state_type &st, result<T> &&ret) noexcept {
+    unique_lock<mutex> g(st.m_);
+    if (is_stream_end(ret)) {
+      st.ended_ = true;
+      if (!ret)
+        st.end_ec_ = ret.error();
+    }
+    if (!st.waiter_) {
+      st.ready_.push_back(move(ret));
+      return;
+    }
+    auto cb = move(st.waiter_);
+    st.waiter_ = nullptr;
+    g.unlock();
+    cb(move(ret));
+  }
+
+public:
+  /*!
+   * \brief starts the operation on f, start is given the callback invoked
+   * with each result, and returns the handle to cancel it
+   */
+  multishot_stream(Fd &f, start_t &&start) noexcept
+      : state_(make_shared<state_type>()) {
+    handle_ = start(
+        f, [state = state_](result<T> ret) { push(*state, move(ret)); });
+  }
+
+  multishot_stream(const multishot_stream &) = delete;
+  multishot_stream &operator=(const multishot_stream &) = delete;
+
+  multishot_stream(multishot_stream &&other) noexcept
+      : state_(move(other.state_)), handle_(move(other.handle_)) {}
+
+  ~multishot_stream() noexcept {
+    if (!handle_)
+      return;
+    static_cast<void>(async::cancel(*handle_));
+  }
+
+  /*!
+   * \brief returns an Awaitable which yields the next result
+   */
+  auto next() noexcept {
+    Expects(state_);
+    return next_awaitable(state_);
+  }
+};
+
 /*! @} */
 
 } // namespace ark
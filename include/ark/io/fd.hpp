@@ -25,11 +25,27 @@ class fd : public with_async_context {
 private:
   struct base_type {
     int fd_;
+    // slot in the registered file table of files_ctx_, -1 if not registered
+    int fixed_{-1};
+    async_context *files_ctx_{nullptr};
 
     base_type(int fd_int) noexcept : fd_(fd_int) {}
 
+    // empties the slot of the registered file table, if any
+    result<void> close_fixed() noexcept {
+      if (fixed_ == -1) {
+        return success();
+      }
+      return files_ctx_->close_file(exchange(fixed_, -1));
+    }
+
     result<void> close() noexcept {
-      if (clinux::close(fd_) != 0) {
+      auto fixed_ret = close_fixed();
+      if (fd_ == -1) {
+        return fixed_ret;
+      }
+      // linux releases the fildes even if close() fails
+      if (clinux::close(exchange(fd_, -1)) != 0) {
         return errno_ec();
       }
       return success();
@@ -47,10 +63,21 @@ public:
   /*!
    * \brief call close() on the fd
    *
-   * if the object is empty, the operation succeeds.
+   * if the object is empty, the operation succeeds. If bound to an
+   * \ref ::ark::async_context, io operations in flight on the fd are cancelled
+   * first, see \ref ::ark::async::cancel. When called from other threads than
+   * the one running the context, the fd is closed asynchronously after the
+   * cancellation, and errors are not reported.
+   *
+   * the destructor closes the fd without cancelling anything, except for the
+   * operations on the slot of the registered file table, if registered
    */
   result<void> close() noexcept {
     if (base_) {
+      OUTCOME_TRY(base_->close_fixed());
+      if (has_async_context() && base_->get() != -1) {
+        return context().cancel_and_close(exchange(base_->fd_, -1));
+      }
       return base_->close();
     }
     return success();
@@ -58,12 +85,49 @@ public:
 
   /*!
    * \brief returns the int fildes
+   *
+   * -1 for the ones only living in the registered file table, see fixed()
    */
   int get() const noexcept {
     Expects(base_);
     return base_->get();
   }
 
+  /*!
+   * \brief installs the fd into the registered file table of the bound
+   * context
+   *
+   * the async io operations on the fd then refer to its slot in the table,
+   * with IOSQE_FIXED_FILE, which saves the kernel looking up and reference
+   * counting the file on each of them. Requires a table to be set up by \ref
+   * ::ark::async_context_options::fixed_files, and kernel >= 5.19.
+   *
+   * \pre bound to an async_context, must be called from the thread running
+   * it (or before it runs)
+   */
+  result<void> register_file() noexcept {
+    Expects(base_);
+    if (base_->fixed_ != -1) {
+      return success();
+    }
+    auto ret = context().register_file(base_->get());
+    if (ret.has_error()) {
+      return ret.as_failure();
+    }
+    base_->fixed_ = ret.value();
+    base_->files_ctx_ = &context();
+    return success();
+  }
+
+  /*!
+   * \brief returns the slot in the registered file table, -1 if not
+   * registered
+   */
+  int fixed() const noexcept {
+    Expects(base_);
+    return base_->fixed_;
+  }
+
 protected:
   /*!
    * \brief constructs an empty fd
@@ -74,6 +138,16 @@ protected:
    * \brief constructs an fd with fildes fd_int
    */
   fd(int fd_int) noexcept : base_(make_unique<base_type>(fd_int)) {}
+
+  /*!
+   * \brief constructs an fd living only in the registered file table of
+   * files_ctx, at slot fixed
+   */
+  fd(int fixed, async_context &files_ctx) noexcept
+      : base_(make_unique<base_type>(-1)) {
+    base_->fixed_ = fixed;
+    base_->files_ctx_ = &files_ctx;
+  }
 };
 
 /*!
@@ -92,11 +166,27 @@ private:
   struct base_type {
     int fd_;
     clinux::off_t offset_{0};
+    // slot in the registered file table of files_ctx_, -1 if not registered
+    int fixed_{-1};
+    async_context *files_ctx_{nullptr};
 
     base_type(int fd_int) noexcept : fd_(fd_int) {}
 
+    // empties the slot of the registered file table, if any
+    result<void> close_fixed() noexcept {
+      if (fixed_ == -1) {
+        return success();
+      }
+      return files_ctx_->close_file(exchange(fixed_, -1));
+    }
+
     result<void> close() noexcept {
-      if (clinux::close(fd_) != 0) {
+      auto fixed_ret = close_fixed();
+      if (fd_ == -1) {
+        return fixed_ret;
+      }
+      // linux releases the fildes even if close() fails
+      if (clinux::close(exchange(fd_, -1)) != 0) {
         return errno_ec();
       }
       return success();
@@ -117,10 +207,21 @@ public:
   /*!
    * \brief call close() on the fd
    *
-   * if the object is empty, the operation succeeds.
+   * if the object is empty, the operation succeeds. If bound to an
+   * \ref ::ark::async_context, io operations in flight on the fd are cancelled
+   * first, see \ref ::ark::async::cancel. When called from other threads than
+   * the one running the context, the fd is closed asynchronously after the
+   * cancellation, and errors are not reported.
+   *
+   * the destructor closes the fd without cancelling anything, except for the
+   * operations on the slot of the registered file table, if registered
    */
   result<void> close() noexcept {
     if (base_) {
+      OUTCOME_TRY(base_->close_fixed());
+      if (has_async_context() && base_->get() != -1) {
+        return context().cancel_and_close(exchange(base_->fd_, -1));
+      }
       return base_->close();
     }
     return success();
@@ -128,12 +229,49 @@ public:
 
   /*!
    * \brief returns the int fildes
+   *
+   * -1 for the ones only living in the registered file table, see fixed()
    */
   int get() const noexcept {
     Expects(base_);
     return base_->get();
   }
 
+  /*!
+   * \brief installs the fd into the registered file table of the bound
+   * context
+   *
+   * the async io operations on the fd then refer to its slot in the table,
+   * with IOSQE_FIXED_FILE, which saves the kernel looking up and reference
+   * counting the file on each of them. Requires a table to be set up by \ref
+   * ::ark::async_context_options::fixed_files, and kernel >= 5.19.
+   *
+   * \pre bound to an async_context, must be called from the thread running
+   * it (or before it runs)
+   */
+  result<void> register_file() noexcept {
+    Expects(base_);
+    if (base_->fixed_ != -1) {
+      return success();
+    }
+    auto ret = context().register_file(base_->get());
+    if (ret.has_error()) {
+      return ret.as_failure();
+    }
+    base_->fixed_ = ret.value();
+    base_->files_ctx_ = &context();
+    return success();
+  }
+
+  /*!
+   * \brief returns the slot in the registered file table, -1 if not
+   * registered
+   */
+  int fixed() const noexcept {
+    Expects(base_);
+    return base_->fixed_;
+  }
+
   /*!
    * \brief returns the offset of next io operations
    */
@@ -170,6 +308,20 @@ protected:
   seekable_fd(int fd_int) noexcept : base_(make_unique<base_type>(fd_int)) {}
 };
 
+/*! \cond HIDDEN_CLASSES */
+
+// the file the async io operations on f refer to
+template <class Fd>
+inline io_uring_async::sqe_file sqe_file_of(const Fd &f) noexcept {
+  if constexpr (requires { f.fixed(); }) {
+    if (f.fixed() != -1)
+      return {f.fixed(), true};
+  }
+  return f.get();
+}
+
+/*! \endcond */
+
 /*! @} */
 
 } // namespace ark
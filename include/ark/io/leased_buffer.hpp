@@ -0,0 +1,116 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async.hpp>
+#include <ark/buffer.hpp>
+
+namespace ark {
+
+/*! \addtogroup io
+ *  @{
+ */
+
+class leased_buffer;
+
+/*! \cond HIDDEN_CLASSES */
+
+inline leased_buffer take_selected_buffer(async_context &ctx,
+                                          size_t sz) noexcept;
+
+/*! \endcond */
+
+/*!
+ * \brief a buffer the kernel picked from the provided buffer ring of an
+ * async_context, holding the data read into it
+ *
+ * The ring is set up by \ref ::ark::async_context_options::provided_buffers,
+ * and its buffers are only taken by the kernel once data arrives, see \ref
+ * ::ark::async::read_some. The buffer is handed back to the ring on
+ * destruction, so it should be released as soon as the data is consumed, and
+ * must not outlive the context.
+ */
+class leased_buffer : public with_async_context {
+private:
+  int bid_{-1};
+  size_t size_{0};
+
+  static leased_buffer __create(async_context *ctx, unsigned short bid,
+                                size_t sz) noexcept {
+    leased_buffer ret;
+    ret.bid_ = bid;
+    ret.size_ = sz;
+    ret.set_async_context(ctx);
+    return ret;
+  }
+
+  friend inline leased_buffer take_selected_buffer(async_context &ctx,
+                                                   size_t sz) noexcept;
+
+public:
+  /*!
+   * \brief constructs an empty buffer, owning nothing
+   */
+  leased_buffer() noexcept {}
+
+  leased_buffer(const leased_buffer &) = delete;
+  leased_buffer &operator=(const leased_buffer &) = delete;
+
+  leased_buffer(leased_buffer &&other) noexcept
+      : with_async_context(other), bid_(exchange(other.bid_, -1)),
+        size_(exchange(other.size_, 0)) {}
+
+  leased_buffer &operator=(leased_buffer &&other) noexcept {
+    release();
+    with_async_context::operator=(other);
+    bid_ = exchange(other.bid_, -1);
+    size_ = exchange(other.size_, 0);
+    return *this;
+  }
+
+  ~leased_buffer() noexcept { release(); }
+
+  /*!
+   * \brief returns the data read into the buffer
+   */
+  mutable_buffer buffer() const noexcept {
+    if (bid_ == -1)
+      return {};
+    auto iov = context().provided_buffer(static_cast<unsigned short>(bid_));
+    return ark::buffer(iov.iov_base, size_);
+  }
+
+  /*!
+   * \brief returns the size of the data, 0 on eof
+   */
+  size_t size() const noexcept { return size_; }
+
+  /*!
+   * \brief hands the buffer back to the ring, done by the destructor as well
+   */
+  void release() noexcept {
+    if (bid_ == -1)
+      return;
+    context().recycle_buffer(static_cast<unsigned short>(exchange(bid_, -1)));
+    size_ = 0;
+  }
+};
+
+/*! \cond HIDDEN_CLASSES */
+
+// the buffer selected for the cqe whose callback is being invoked, or an empty
+// one if the kernel selected none
+inline leased_buffer take_selected_buffer(async_context &ctx,
+                                          size_t sz) noexcept {
+  auto flags = ctx.cqe_flags();
+  if (!(flags & IORING_CQE_F_BUFFER))
+    return {};
+  auto bid = static_cast<unsigned short>(flags >> IORING_CQE_BUFFER_SHIFT);
+  return leased_buffer::__create(&ctx, bid, sz);
+}
+
+/*! \endcond */
+
+/*! @} */
+
+} // namespace ark
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async.hpp>
+#include <ark/buffer.hpp>
+
+namespace ark {
+
+/*! \addtogroup io
+ *  @{
+ */
+
+/*!
+ * \brief a buffer leased from the registered buffer pool of an async_context
+ *
+ * The pool is set up by \ref ::ark::async_context_options::registered_buffers.
+ * Its memory is pinned and mapped into the kernel once, so async reads and
+ * writes on a single buffer lying in it are done with READ_FIXED / WRITE_FIXED
+ * rather than readv / writev, saving the kernel from pinning the pages on each
+ * operation. This is automatic, any part of the buffer could be passed to
+ * \ref ::ark::async::read and friends as usual.
+ *
+ * The buffer is returned to the pool on destruction, and must not outlive the
+ * context.
+ */
+class registered_buffer : public with_async_context {
+private:
+  clinux::iovec iov_{nullptr, 0};
+
+  registered_buffer() noexcept {}
+
+  static result<registered_buffer> __create(async_context *ctx) noexcept {
+    auto iov = ctx->acquire_buffer();
+    if (iov.has_error())
+      return iov.as_failure();
+    registered_buffer ret;
+    ret.iov_ = iov.value();
+    ret.set_async_context(ctx);
+    return move(ret);
+  }
+
+public:
+  registered_buffer(const registered_buffer &) = delete;
+  registered_buffer &operator=(const registered_buffer &) = delete;
+
+  registered_buffer(registered_buffer &&other) noexcept
+      : with_async_context(other),
+        iov_(exchange(other.iov_, clinux::iovec{nullptr, 0})) {}
+
+  registered_buffer &operator=(registered_buffer &&other) noexcept {
+    release();
+    with_async_context::operator=(other);
+    iov_ = exchange(other.iov_, clinux::iovec{nullptr, 0});
+    return *this;
+  }
+
+  ~registered_buffer() noexcept { release(); }
+
+  /*!
+   * \brief takes a buffer from the pool of ctx
+   *
+   * fails with ENOBUFS if all of them are in use
+   */
+  static result<registered_buffer> create(async_context &ctx) noexcept {
+    return __create(&ctx);
+  }
+
+  /*!
+   * \brief returns the whole buffer
+   */
+  mutable_buffer buffer() const noexcept {
+    return ark::buffer(iov_.iov_base, iov_.iov_len);
+  }
+
+  /*!
+   * \brief returns the size of the buffer
+   */
+  size_t size() const noexcept { return iov_.iov_len; }
+
+  /*!
+   * \brief returns the buffer to the pool, done by the destructor as well
+   */
+  void release() noexcept {
+    if (iov_.iov_base == nullptr)
+      return;
+    context().release_buffer(exchange(iov_.iov_base, nullptr));
+    iov_.iov_len = 0;
+  }
+};
+
+/*! @} */
+
+} // namespace ark
@@ -0,0 +1,96 @@
+#pragma once
+
+/*! \cond FILE_NOT_DOCUMENTED */
+
+#include <ark/bindings.hpp>
+
+namespace ark {
+
+/*
+ * bounded Chase-Lev deque, as described in "Correct and Efficient
+ * Work-Stealing for Weak Memory Models" (Le et al., PPoPP'13)
+ *
+ * the owner thread pushes and pops at the bottom, any other thread may steal
+ * from the top, all lock-free. push() fails when the deque is full, the owner
+ * is expected to fall back to some other queue.
+ *
+ * T must be trivially copyable, and T{} is returned for nothing.
+ */
+template <typename T, size_t Capacity = 1024> class work_stealing_deque {
+private:
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of 2");
+  static_assert(is_trivially_copyable_v<T>);
+
+  static const constexpr int64_t mask = Capacity - 1;
+
+  alignas(64) atomic<int64_t> top_{0};
+  alignas(64) atomic<int64_t> bottom_{0};
+  array<atomic<T>, Capacity> buf_;
+
+public:
+  work_stealing_deque() noexcept {}
+
+  // owner only
+  bool push(T v) noexcept {
+    int64_t b = bottom_.load(memory_order_relaxed);
+    int64_t t = top_.load(memory_order_acquire);
+    if (b - t >= static_cast<int64_t>(Capacity))
+      return false;
+    buf_[b & mask].store(v, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    bottom_.store(b + 1, memory_order_relaxed);
+    return true;
+  }
+
+  // owner only
+  T pop() noexcept {
+    int64_t b = bottom_.load(memory_order_relaxed) - 1;
+    bottom_.store(b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = top_.load(memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, memory_order_relaxed);
+      return T{};
+    }
+    T v = buf_[b & mask].load(memory_order_relaxed);
+    if (t == b) {
+      // the last one, race against thieves
+      if (!top_.compare_exchange_strong(t, t + 1, memory_order_seq_cst,
+                                        memory_order_relaxed))
+        v = T{};
+      bottom_.store(b + 1, memory_order_relaxed);
+    }
+    return v;
+  }
+
+  // any thread
+  T steal() noexcept {
+    int64_t t = top_.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = bottom_.load(memory_order_acquire);
+    if (t >= b)
+      return T{};
+    T v = buf_[t & mask].load(memory_order_relaxed);
+    if (!top_.compare_exchange_strong(t, t + 1, memory_order_seq_cst,
+                                      memory_order_relaxed))
+      return T{};
+    return v;
+  }
+
+  // any thread, a snapshot only
+  bool empty() const noexcept {
+    int64_t t = top_.load(memory_order_relaxed);
+    int64_t b = bottom_.load(memory_order_relaxed);
+    return b <= t;
+  }
+
+  work_stealing_deque(work_stealing_deque &&) = delete;
+  work_stealing_deque &operator=(work_stealing_deque &&) = delete;
+  work_stealing_deque(const work_stealing_deque &) = delete;
+  work_stealing_deque &operator=(const work_stealing_deque &) = delete;
+};
+
+} // namespace ark
+
+/*! \endcond */
@@ -5,7 +5,8 @@
  *
  * Due to the complexity of network stack, the common stuff, like network
  * address, is placed under namespace \ref ::ark::net, while specific protocol
- * implementions placed under sub-namespaces, like \ref ::ark::net::tcp.
+ * implementions placed under sub-namespaces, like \ref ::ark::net::tcp and
+ * \ref ::ark::net::udp.
  */
 
 namespace ark {
@@ -18,3 +19,4 @@ namespace net {}
 #include <ark/net/address.hpp>
 
 #include <ark/net/tcp.hpp>
+#include <ark/net/udp.hpp>
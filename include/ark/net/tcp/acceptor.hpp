@@ -27,6 +27,8 @@ protected:
   acceptor(int fd_int) : fd(fd_int) {}
 
 private:
+  bool direct_accept_{false};
+
   static result<acceptor> __create(async_context *ctx,
                                    bool use_ipv6 = false) noexcept {
     int ret = clinux::socket(use_ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
@@ -61,6 +63,33 @@ public:
                                  bool use_ipv6 = false) noexcept {
     return __create(&ctx, use_ipv6);
   }
+
+  /*!
+   * \brief let the async accepts place the sockets directly into the
+   * registered file table of the bound context
+   *
+   * off by default. Once set, sockets accepted by the async, coro and
+   * multishot accepts only live in the table, which saves installing and
+   * looking up a fildes for each of them, see \ref
+   * ::ark::async_context_options::fixed_files. Their get() returns -1, thus
+   * only the async io functions could be used on them, the sync ones, \ref
+   * ::ark::net::tcp::sync::transfer_file and the ones setting socket options
+   * fail with EBADF. Has no effect if the context could not accept directly,
+   * i.e. without a table, or before kernel 6.0.
+   *
+   * \pre no async accept in flight on the acceptor
+   */
+  void set_direct_accept(bool enable = true) noexcept {
+    direct_accept_ = enable;
+  }
+
+  /*!
+   * \brief if the async accepts place the sockets directly into the
+   * registered file table, see set_direct_accept()
+   */
+  bool direct_accept() const noexcept {
+    return direct_accept_ && context().direct_accept();
+  }
 };
 } // namespace tcp
 
@@ -4,6 +4,8 @@
 
 #include <ark/async/async_op.hpp>
 #include <ark/async/context.hpp>
+#include <ark/general/normal_file.hpp>
+#include <ark/io/async.hpp>
 #include <ark/net/address.hpp>
 #include <ark/net/tcp/acceptor.hpp>
 #include <ark/net/tcp/socket.hpp>
@@ -17,11 +19,67 @@ namespace net {
 
 namespace tcp {
 
+/*!
+ * \brief the bytes relayed in each direction, see \ref
+ * ::ark::net::tcp::async::relay
+ */
+struct relay_counters {
+  /*!
+   * \brief bytes moved from a to b
+   */
+  size_t a_to_b{0};
+
+  /*!
+   * \brief bytes moved from b to a
+   */
+  size_t b_to_a{0};
+};
+
 /*!
  * \brief contains apis that invokes a given \ref ::ark::callback on completion
  */
 namespace async {
 
+/*! \cond HIDDEN_CLASSES */
+
+// accepts into the registered file table if the acceptor opted in, see
+// accepted_socket()
+inline result<async_context::token_t>
+accept_syscall(acceptor &srv, clinux::sockaddr *addr,
+               clinux::socklen_t *addrlen, syscall_callback_t &&cb) noexcept {
+  auto &ctx = srv.context();
+  auto f = sqe_file_of(srv);
+  if (srv.direct_accept())
+    return async_syscall::accept_direct(ctx, f, addr, addrlen, 0,
+                                        forward<syscall_callback_t>(cb));
+  return async_syscall::accept(ctx, f, addr, addrlen, 0,
+                               forward<syscall_callback_t>(cb));
+}
+
+inline result<void> accept_syscall(acceptor &srv, clinux::sockaddr *addr,
+                                   clinux::socklen_t *addrlen,
+                                   clinux::__kernel_timespec *deadline,
+                                   syscall_callback_t &&cb) noexcept {
+  auto &ctx = srv.context();
+  auto f = sqe_file_of(srv);
+  if (srv.direct_accept())
+    return async_syscall::accept_direct(ctx, f, addr, addrlen, 0, deadline,
+                                        forward<syscall_callback_t>(cb));
+  return async_syscall::accept(ctx, f, addr, addrlen, 0, deadline,
+                               forward<syscall_callback_t>(cb));
+}
+
+// ret is the fildes, or the slot in the registered file table, of a socket
+// accepted by accept_syscall()
+inline socket accepted_socket(acceptor &srv, long ret) noexcept {
+  auto &ctx = srv.context();
+  if (srv.direct_accept())
+    return wrap_accepted_direct_socket(ctx, static_cast<int>(ret));
+  return wrap_accepted_socket(&ctx, static_cast<int>(ret));
+}
+
+/*! \endcond */
+
 /*!
  * \brief connect socket to the given endpoint
  *
@@ -30,10 +88,10 @@ namespace async {
 inline void connect(socket &f, const address &endpoint,
                     callback<result<void>> &&cb) noexcept {
   auto ret = async_syscall::connect(
-      f.context(), f.get(), endpoint.sa_ptr(), endpoint.sa_len(),
+      f.context(), sqe_file_of(f), endpoint.sa_ptr(), endpoint.sa_len(),
       [cb(forward<callback<result<void>>>(cb))](result<long> ret) mutable {
         if (!ret)
-          cb(ret.error());
+          return cb(ret.error());
         cb(success());
       });
   if (ret.has_error())
@@ -42,6 +100,62 @@ inline void connect(socket &f, const address &endpoint,
 
 /*! \cond HIDDEN_CLASSES */
 
+struct connect_with_deadline_impl {
+  struct locals_t {
+    socket &f_;
+    const address &endpoint_;
+    op_deadline deadline_;
+
+    locals_t(socket &f, const address &endpoint,
+             chrono::steady_clock::time_point deadline) noexcept
+        : f_(f), endpoint_(endpoint), deadline_(deadline) {}
+  };
+  using ret_t = result<void>;
+  using op_t = async_op<connect_with_deadline_impl>;
+
+  static void run(op_t &op) noexcept {
+    auto &ctx = op.ctx_;
+    auto fd = sqe_file_of(op.locals_->f_);
+    auto sa_ptr = op.locals_->endpoint_.sa_ptr();
+    auto sa_len = op.locals_->endpoint_.sa_len();
+    auto ts_ptr = addressof(op.locals_->deadline_.ts_);
+    auto ret = async_syscall::connect(
+        ctx, fd, sa_ptr, sa_len, ts_ptr,
+        op.yield_syscall(connect_with_deadline_impl::finish));
+    if (ret.has_error())
+      return op.complete(ret.as_failure());
+  }
+
+  static void finish(op_t &op, result<long> ret) noexcept {
+    ret = op.locals_->deadline_.translate(move(ret));
+    if (!ret)
+      return op.complete(ret.error());
+    op.complete(success());
+  }
+};
+
+/*! \endcond */
+
+/*!
+ * \brief connect socket to the given endpoint, failing once deadline is
+ * reached
+ *
+ * returns instantly, cb is invoked on completion or error. The connect syscall
+ * is linked to a timeout in the kernel, cb gets errc::timed_out once deadline
+ * is reached.
+ */
+inline void connect(socket &f, const address &endpoint,
+                    chrono::steady_clock::time_point deadline,
+                    callback<result<void>> &&cb) noexcept {
+  using impl_t = connect_with_deadline_impl;
+  async_op<impl_t>(
+      f.context(), forward<callback<result<void>>>(cb),
+      make_unique<typename impl_t::locals_t>(f, endpoint, deadline))
+      .run();
+}
+
+/*! \cond HIDDEN_CLASSES */
+
 struct accept_with_address_impl {
   struct locals_t {
     acceptor &f_;
@@ -56,22 +170,20 @@ struct accept_with_address_impl {
   using op_t = async_op<accept_with_address_impl>;
 
   static void run(op_t &op) noexcept {
-    auto &ctx = op.ctx_;
-    auto fd = op.locals_->f_.get();
+    auto &srv = op.locals_->f_;
     auto sa_ptr = op.locals_->endpoint_.sa_ptr();
     auto addr_ptr = addressof(op.locals_->addrlen_buf);
-    auto ret = async_syscall::accept(
-        ctx, fd, sa_ptr, addr_ptr, 0,
-        op.yield_syscall(accept_with_address_impl::finish));
+    auto ret =
+        accept_syscall(srv, sa_ptr, addr_ptr,
+                       op.yield_syscall(accept_with_address_impl::finish));
     if (ret.has_error())
       return op.complete(ret.as_failure());
   }
 
   static void finish(op_t &op, result<long> ret) noexcept {
-    if (!ret) {
-      op.complete(ret.error());
-    }
-    op.complete(wrap_accepted_socket(&op.ctx_, static_cast<int>(ret.value())));
+    if (!ret)
+      return op.complete(ret.error());
+    op.complete(accepted_socket(op.locals_->f_, ret.value()));
   }
 };
 
@@ -98,18 +210,412 @@ inline void accept(acceptor &srv, address &endpoint,
  * returns instantly, cb is invoked on completion or error.
  */
 inline void accept(acceptor &srv, callback<result<socket>> &&cb) noexcept {
-  auto ret = async_syscall::accept(
-      srv.context(), srv.get(), NULL, NULL, 0,
-      [&ctx(srv.context()),
-       cb(forward<callback<result<socket>>>(cb))](result<long> ret) mutable {
+  auto ret = accept_syscall(
+      srv, NULL, NULL,
+      [&srv, cb(forward<callback<result<socket>>>(cb))](
+          result<long> ret) mutable {
         if (!ret)
-          cb(ret.error());
-        cb(wrap_accepted_socket(&ctx, static_cast<int>(ret.value())));
+          return cb(ret.error());
+        cb(accepted_socket(srv, ret.value()));
       });
   if (ret.has_error())
     cb(ret.as_failure());
 }
 
+/*! \cond HIDDEN_CLASSES */
+
+struct accept_with_deadline_impl {
+  struct locals_t {
+    acceptor &f_;
+    op_deadline deadline_;
+
+    locals_t(acceptor &f, chrono::steady_clock::time_point deadline) noexcept
+        : f_(f), deadline_(deadline) {}
+  };
+  using ret_t = result<socket>;
+  using op_t = async_op<accept_with_deadline_impl>;
+
+  static void run(op_t &op) noexcept {
+    auto &srv = op.locals_->f_;
+    auto ts_ptr = addressof(op.locals_->deadline_.ts_);
+    auto ret =
+        accept_syscall(srv, NULL, NULL, ts_ptr,
+                       op.yield_syscall(accept_with_deadline_impl::finish));
+    if (ret.has_error())
+      return op.complete(ret.as_failure());
+  }
+
+  static void finish(op_t &op, result<long> ret) noexcept {
+    ret = op.locals_->deadline_.translate(move(ret));
+    if (!ret)
+      return op.complete(ret.error());
+    op.complete(accepted_socket(op.locals_->f_, ret.value()));
+  }
+};
+
+/*! \endcond */
+
+/*!
+ * \brief accept a socket connection from the given acceptor, failing once
+ * deadline is reached
+ *
+ * returns instantly, cb is invoked on completion or error. The accept syscall
+ * is linked to a timeout in the kernel, cb gets errc::timed_out once deadline
+ * is reached.
+ */
+inline void accept(acceptor &srv, chrono::steady_clock::time_point deadline,
+                   callback<result<socket>> &&cb) noexcept {
+  using impl_t = accept_with_deadline_impl;
+  async_op<impl_t>(srv.context(), forward<callback<result<socket>>>(cb),
+                   make_unique<typename impl_t::locals_t>(srv, deadline))
+      .run();
+}
+
+/*! \cond HIDDEN_CLASSES */
+
+// owned by the accepts in flight, released once stopped for good
+struct accept_multishot_state {
+  acceptor &srv_;
+  callback<result<socket>> cb_;
+  shared_ptr<multishot_handle> handle_;
+  // cleared on kernels without multishot accept, then re-armed per accept
+  bool multishot_{true};
+
+  accept_multishot_state(acceptor &srv, callback<result<socket>> &&cb) noexcept
+      : srv_(srv), cb_(forward<callback<result<socket>>>(cb)),
+        handle_(make_shared<multishot_handle>(srv.context())) {}
+};
+
+inline void arm_accept_multishot(accept_multishot_state *p_state) noexcept;
+
+// ECONNABORTED only fails the connection, not the acceptor
+inline bool is_accept_rearmable(const result<long> &ret) noexcept {
+  return ret.has_value() || ret.error().value() == ECONNABORTED;
+}
+
+inline void finish_accept_multishot(accept_multishot_state *p_state,
+                                    error_code ec) noexcept {
+  unique_ptr<accept_multishot_state> state{p_state};
+  state->cb_(ec);
+}
+
+inline void on_accept_multishot(accept_multishot_state *p_state,
+                                result<long> ret, bool more) noexcept {
+  if (ret)
+    p_state->cb_(accepted_socket(p_state->srv_, ret.value()));
+  if (more)
+    return;
+  if (!ret && ret.error().value() == EINVAL && p_state->multishot_) {
+    // multishot accept requires kernel >= 5.19, fall back to re-arming
+    p_state->multishot_ = false;
+    return arm_accept_multishot(p_state);
+  }
+  // the kernel stops it on errors, and once the cq overflowed
+  if (is_accept_rearmable(ret))
+    return arm_accept_multishot(p_state);
+  finish_accept_multishot(p_state, ret.error());
+}
+
+inline void arm_accept_multishot(accept_multishot_state *p_state) noexcept {
+  auto &srv = p_state->srv_;
+  auto &ctx = srv.context();
+  if (p_state->handle_->cancelled())
+    return finish_accept_multishot(p_state, as_ec(ECANCELED));
+  auto ret =
+      p_state->multishot_
+          ? async_syscall::accept_multishot(
+                ctx, sqe_file_of(srv), 0, srv.direct_accept(),
+                [p_state](result<long> ret, bool more) {
+                  on_accept_multishot(p_state, move(ret), more);
+                })
+          : accept_syscall(srv, NULL, NULL, [p_state](result<long> ret) {
+              on_accept_multishot(p_state, move(ret), false);
+            });
+  if (ret.has_error())
+    return finish_accept_multishot(p_state, ret.error());
+  p_state->handle_->armed(ret.value());
+}
+
+/*! \endcond */
+
+/*!
+ * \brief accept socket connections from the given acceptor, until cancelled
+ *
+ * returns instantly, cb is invoked with each accepted connection. A single
+ * multishot accept is kept armed in the kernel for all of them, rather than
+ * an accept per connection, and is re-armed if the kernel stops it, e.g. once
+ * the completion queue overflowed. Connections aborted before being accepted
+ * are skipped.
+ *
+ * Stop it with \ref ::ark::async::cancel on the returned handle, which leaves
+ * the other operations on srv alone, or on srv, after which cb is invoked for
+ * the last time with ECANCELED, or with the error that stopped it. srv must
+ * outlive that.
+ *
+ * requires kernel >= 5.19, falls back to an accept per connection otherwise
+ */
+inline shared_ptr<multishot_handle>
+accept_multishot(acceptor &srv, callback<result<socket>> &&cb) noexcept {
+  auto state = make_unique<accept_multishot_state>(
+      srv, forward<callback<result<socket>>>(cb));
+  auto handle = state->handle_;
+  arm_accept_multishot(state.release());
+  return handle;
+}
+
+/*! \cond HIDDEN_CLASSES */
+
+// owned by the receive in flight, released once stopped for good
+struct receive_multishot_state {
+  socket &s_;
+  callback<result<leased_buffer>> cb_;
+  shared_ptr<multishot_handle> handle_;
+  // cleared on kernels without multishot receive, then re-armed per chunk
+  bool multishot_{true};
+  // re-arms it a tick later, once the ring ran out of buffers
+  async_context::timer_entry backoff_;
+  // the cancellations of s_ seen on start, it ends once another one happens
+  unsigned cancels_;
+
+  receive_multishot_state(socket &s,
+                          callback<result<leased_buffer>> &&cb) noexcept;
+};
+
+inline void arm_receive_multishot(receive_multishot_state *p_state) noexcept;
+
+inline receive_multishot_state::receive_multishot_state(
+    socket &s, callback<result<leased_buffer>> &&cb) noexcept
+    : s_(s), cb_(forward<callback<result<leased_buffer>>>(cb)),
+      handle_(make_shared<multishot_handle>(s.context())),
+      backoff_([this]() { arm_receive_multishot(this); }),
+      cancels_(s.cancels()) {}
+
+inline void finish_receive_multishot(receive_multishot_state *p_state,
+                                     result<leased_buffer> ret) noexcept {
+  unique_ptr<receive_multishot_state> state{p_state};
+  state->cb_(move(ret));
+}
+
+inline void on_receive_multishot(receive_multishot_state *p_state,
+                                 result<long> ret, bool more) noexcept {
+  auto &s = p_state->s_;
+  if (!ret) {
+    if (more)
+      return;
+    if (ret.error().value() == EINVAL && p_state->multishot_) {
+      // multishot receive requires kernel >= 6.0, fall back to re-arming
+      p_state->multishot_ = false;
+      return arm_receive_multishot(p_state);
+    }
+    // ran out of provided buffers, which are handed back as soon as the
+    // chunks are consumed. Re-arming right away would spin as long as the
+    // application holds all of them, so it waits for the next tick
+    if (ret.error().value() == ENOBUFS)
+      return s.context().arm_timer(p_state->backoff_, chrono::nanoseconds{1});
+    return finish_receive_multishot(p_state, ret.error());
+  }
+  auto sz = static_cast<size_t>(ret.value());
+  auto b = take_selected_buffer(s.context(), sz);
+  if (sz == 0) // eof
+    return finish_receive_multishot(p_state, move(b));
+  s.refresh_idle_timeout();
+  p_state->cb_(move(b));
+  // the kernel stops it once the cq overflowed
+  if (!more)
+    arm_receive_multishot(p_state);
+}
+
+inline void arm_receive_multishot(receive_multishot_state *p_state) noexcept {
+  auto &s = p_state->s_;
+  auto &ctx = s.context();
+  // nothing is in flight while backing off, the cancellation of s would go
+  // unnoticed otherwise
+  if (p_state->handle_->cancelled() || s.cancels() != p_state->cancels_)
+    return finish_receive_multishot(p_state, as_ec(ECANCELED));
+  auto ret =
+      p_state->multishot_
+          ? async_syscall::recv_multishot(
+                ctx, sqe_file_of(s), async_context::provided_buffer_group,
+                [p_state](result<long> ret, bool more) {
+                  on_receive_multishot(p_state, move(ret), more);
+                })
+          : async_syscall::read_select(
+                ctx, sqe_file_of(s), 0, async_context::provided_buffer_group,
+                [p_state](result<long> ret) {
+                  on_receive_multishot(p_state, move(ret), false);
+                });
+  if (ret.has_error())
+    return finish_receive_multishot(p_state, ret.error());
+  p_state->handle_->armed(ret.value());
+}
+
+/*! \endcond */
+
+/*!
+ * \brief receive from the socket until eof or cancelled, into buffers picked
+ * from the provided buffer ring of the bound context
+ *
+ * returns instantly, cb is invoked with each chunk received. A single
+ * multishot receive is kept armed in the kernel for all of them, rather than
+ * a read per chunk as \ref ::ark::async::read does, and is re-armed if the
+ * kernel stops it, e.g. a timer tick after the ring ran out of buffers, see
+ * \ref ::ark::async_context_options::timer_tick. The chunks should be
+ * released as soon as consumed, see \ref ::ark::leased_buffer.
+ *
+ * On eof cb is invoked for the last time with an empty buffer. Stop it with
+ * \ref ::ark::async::cancel on the returned handle, which leaves the other
+ * operations on s alone, or on s, or by closing s, after which cb is invoked
+ * for the last time with ECANCELED, or with the error that stopped it, even
+ * while waiting for buffers. The idle timeout of s only stops it once the
+ * receive is in flight. s must outlive that, and must not be moved meanwhile,
+ * as the receive keeps referring to it.
+ *
+ * requires kernel >= 6.0, falls back to a read per chunk on 5.19, fails with
+ * ENOBUFS if the provided buffer ring is not set up, see \ref
+ * ::ark::async_context_options::provided_buffers
+ */
+inline shared_ptr<multishot_handle>
+receive_multishot(socket &s, callback<result<leased_buffer>> &&cb) noexcept {
+  auto state = make_unique<receive_multishot_state>(
+      s, forward<callback<result<leased_buffer>>>(cb));
+  auto handle = state->handle_;
+  if (!s.context().has_provided_buffers()) {
+    finish_receive_multishot(state.release(), as_ec(ENOBUFS));
+    return handle;
+  }
+  arm_receive_multishot(state.release());
+  return handle;
+}
+
+/*! \cond HIDDEN_CLASSES */
+
+struct relay_state {
+  socket &a_;
+  socket &b_;
+  relay_counters &counters_;
+  callback<result<void>> cb_;
+  int running_{2};
+  error_code ec_;
+
+  relay_state(socket &a, socket &b, relay_counters &counters,
+              callback<result<void>> &&cb) noexcept
+      : a_(a), b_(b), counters_(counters),
+        cb_(forward<callback<result<void>>>(cb)) {}
+};
+
+// the counters are updated each time a direction moved this many bytes
+static const constexpr size_t relay_chunk = 1024 * 1024;
+
+inline result<void> relay_shutdown(socket &s, int how,
+                                   syscall_callback_t &&cb) noexcept {
+  auto ret = async_syscall::shutdown(s.context(), sqe_file_of(s), how,
+                                     forward<syscall_callback_t>(cb));
+  if (!ret)
+    return ret.as_failure();
+  return success();
+}
+
+inline void finish_relay_direction(relay_state *p_state,
+                                   error_code ec) noexcept {
+  if (ec && !p_state->ec_) {
+    p_state->ec_ = ec;
+    // a splice blocked reading from a socket is not cancelled by fd, as the
+    // file of the operation is the pipe, but it returns once shut down
+    static_cast<void>(
+        relay_shutdown(p_state->a_, SHUT_RDWR, [](result<long>) {}));
+    static_cast<void>(
+        relay_shutdown(p_state->b_, SHUT_RDWR, [](result<long>) {}));
+  }
+  if (--p_state->running_ != 0)
+    return;
+  unique_ptr<relay_state> state{p_state};
+  if (state->ec_)
+    return state->cb_(state->ec_);
+  state->cb_(success());
+}
+
+inline void relay_direction(relay_state *p_state, bool a_to_b) noexcept {
+  socket &from = a_to_b ? p_state->a_ : p_state->b_;
+  socket &to = a_to_b ? p_state->b_ : p_state->a_;
+  ark::async::splice(
+      from, to, relay_chunk, [p_state, a_to_b, &to](result<size_t> ret) {
+        if (!ret)
+          return finish_relay_direction(p_state, ret.error());
+        auto &counter = a_to_b ? p_state->counters_.a_to_b
+                               : p_state->counters_.b_to_a;
+        counter += ret.value();
+        // the other direction failed
+        if (p_state->ec_)
+          return finish_relay_direction(p_state, {});
+        if (ret.value() == relay_chunk)
+          return relay_direction(p_state, a_to_b);
+        // eof, passed on as a half close
+        auto shutdown_ret =
+            relay_shutdown(to, SHUT_WR, [p_state](result<long> ret) {
+              if (!ret && ret.error().value() != ENOTCONN)
+                return finish_relay_direction(p_state, ret.error());
+              finish_relay_direction(p_state, {});
+            });
+        if (!shutdown_ret)
+          finish_relay_direction(p_state, shutdown_ret.error());
+      });
+}
+
+/*! \endcond */
+
+/*!
+ * \brief relay the bytes between two connected sockets in both directions,
+ * without copying them to user space, until both of them reached eof
+ *
+ * returns instantly, cb is invoked once both directions ended. Each direction
+ * is spliced through a pipe of the bound context, with the splices into and
+ * out of it linked, see \ref ::ark::async::splice. Eof of one of the sockets
+ * is passed on to the other one by shutting down its writing side, while the
+ * other direction goes on, so that half closed connections are relayed as
+ * is. Once a direction fails, both of the sockets are shut down, and cb gets
+ * its error after the other direction ended as well.
+ *
+ * counters are updated as the bytes are relayed, at least once per MiB and
+ * once a direction ends, and must outlive the relay, as must the sockets,
+ * which must be bound to the same context. Requires kernel >= 5.11.
+ */
+inline void relay(socket &a, socket &b, relay_counters &counters,
+                  callback<result<void>> &&cb) noexcept {
+  auto state = make_unique<relay_state>(a, b, counters,
+                                        forward<callback<result<void>>>(cb));
+  auto *p_state = state.release();
+  relay_direction(p_state, true);
+  relay_direction(p_state, false);
+}
+
+/*!
+ * \brief send up to len bytes of the file to the socket, starting from the
+ * offset of the file, without copying them to user space, as sendfile(2)
+ *
+ * returns instantly, cb is invoked on completion or error, with the number of
+ * bytes sent, less than len only if the end of the file is reached. Each
+ * chunk is spliced from the file into a pipe of the bound context, linked to
+ * a splice from the pipe to the socket, so that the kernel does both halves
+ * without a round trip to user space, see \ref ::ark::async::splice.
+ *
+ * the offset of the file is advanced by the bytes sent, even on error.
+ */
+inline void transfer_file(normal_file &f, size_t len, socket &s,
+                          callback<result<size_t>> &&cb) noexcept {
+  ark::async::splice(f, s, len, forward<callback<result<size_t>>>(cb));
+}
+
+/*!
+ * \brief send up to len bytes of the file, starting from off, to the socket
+ *
+ * same as seeking the file to off, then transfer_file(f, len, s, cb)
+ */
+inline void transfer_file(normal_file &f, clinux::off_t off, size_t len,
+                          socket &s, callback<result<size_t>> &&cb) noexcept {
+  f.seek(off);
+  transfer_file(f, len, s, forward<callback<result<size_t>>>(cb));
+}
+
 } // namespace async
 } // namespace tcp
 
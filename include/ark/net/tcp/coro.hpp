@@ -4,6 +4,7 @@
 
 #include <ark/async/context.hpp>
 #include <ark/coroutine/awaitable_op.hpp>
+#include <ark/io/coro.hpp>
 #include <ark/net/address.hpp>
 #include <ark/net/tcp/async.hpp>
 #include <ark/net/tcp/socket.hpp>
@@ -36,6 +37,53 @@ struct connect_awaitable : public awaitable_op<result<void>> {
   }
 };
 
+struct connect_with_deadline_awaitable : public awaitable_op<result<void>> {
+  socket &f_;
+  const address &endpoint_;
+  chrono::steady_clock::time_point deadline_;
+
+  connect_with_deadline_awaitable(
+      socket &f, const address &endpoint,
+      chrono::steady_clock::time_point deadline) noexcept
+      : f_(f), endpoint_(endpoint), deadline_(deadline) {}
+
+  void invoke(callback<result<void>> &&cb) noexcept override {
+    async::connect(f_, endpoint_, deadline_,
+                   forward<callback<result<void>>>(cb));
+  }
+};
+
+struct transfer_file_awaitable : public awaitable_op<result<size_t>> {
+  normal_file &f_;
+  optional<clinux::off_t> off_;
+  size_t len_;
+  socket &s_;
+
+  transfer_file_awaitable(normal_file &f, optional<clinux::off_t> off,
+                          size_t len, socket &s) noexcept
+      : f_(f), off_(off), len_(len), s_(s) {}
+
+  void invoke(callback<result<size_t>> &&cb) noexcept override {
+    if (off_)
+      return async::transfer_file(f_, *off_, len_, s_,
+                                  forward<callback<result<size_t>>>(cb));
+    async::transfer_file(f_, len_, s_, forward<callback<result<size_t>>>(cb));
+  }
+};
+
+struct relay_awaitable : public awaitable_op<result<void>> {
+  socket &a_;
+  socket &b_;
+  relay_counters &counters_;
+
+  relay_awaitable(socket &a, socket &b, relay_counters &counters) noexcept
+      : a_(a), b_(b), counters_(counters) {}
+
+  void invoke(callback<result<void>> &&cb) noexcept override {
+    async::relay(a_, b_, counters_, forward<callback<result<void>>>(cb));
+  }
+};
+
 /*! \endcond */
 
 /*!
@@ -47,6 +95,18 @@ inline auto connect(socket &f, const address &endpoint) noexcept {
   return connect_awaitable(f, endpoint);
 }
 
+/*!
+ * \brief connect socket to the given endpoint, failing once deadline is
+ * reached
+ *
+ * returns an Awaitable which yields an result<void> when co_awaited, which is
+ * errc::timed_out once deadline is reached.
+ */
+inline auto connect(socket &f, const address &endpoint,
+                    chrono::steady_clock::time_point deadline) noexcept {
+  return connect_with_deadline_awaitable(f, endpoint, deadline);
+}
+
 /*! \cond HIDDEN_CLASSES */
 
 struct accept_with_ep_awaitable : public awaitable_op<result<socket>> {
@@ -71,6 +131,19 @@ struct accept_awaitable : public awaitable_op<result<socket>> {
   }
 };
 
+struct accept_with_deadline_awaitable : public awaitable_op<result<socket>> {
+  acceptor &srv_;
+  chrono::steady_clock::time_point deadline_;
+
+  accept_with_deadline_awaitable(
+      acceptor &srv, chrono::steady_clock::time_point deadline) noexcept
+      : srv_(srv), deadline_(deadline) {}
+
+  void invoke(callback<result<socket>> &&cb) noexcept override {
+    async::accept(srv_, deadline_, forward<callback<result<socket>>>(cb));
+  }
+};
+
 /*! \endcond */
 
 /*!
@@ -91,6 +164,110 @@ inline auto accept(acceptor &srv, address &endpoint) noexcept {
  */
 inline auto accept(acceptor &srv) noexcept { return accept_awaitable(srv); }
 
+/*!
+ * \brief accept a socket connection from the given acceptor, failing once
+ * deadline is reached
+ *
+ * returns an Awaitable which yields an result<socket> when co_awaited, which is
+ * errc::timed_out once deadline is reached.
+ */
+inline auto accept(acceptor &srv,
+                   chrono::steady_clock::time_point deadline) noexcept {
+  return accept_with_deadline_awaitable(srv, deadline);
+}
+
+/*!
+ * \brief the connections accepted by a multishot accept, see \ref
+ * ::ark::net::tcp::coro::accept_multishot and \ref ::ark::multishot_stream
+ */
+using accept_stream = multishot_stream<acceptor, socket>;
+
+/*!
+ * \brief accept socket connections from the given acceptor with a single
+ * multishot accept
+ *
+ * returns a stream, whose next() yields each accepted connection, see \ref
+ * ::ark::net::tcp::async::accept_multishot
+ *
+ * \code
+ * auto stream = tcp::coro::accept_multishot(ac);
+ * for (;;) {
+ *   tcp::socket s = CoTryX(co_await stream.next());
+ *   co_async(handle_conn(std::move(s)));
+ * }
+ * \endcode
+ */
+inline accept_stream accept_multishot(acceptor &srv) noexcept {
+  return accept_stream(srv, [](acceptor &srv, callback<result<socket>> &&cb) {
+    return async::accept_multishot(srv, forward<callback<result<socket>>>(cb));
+  });
+}
+
+/*!
+ * \brief the chunks received by a multishot receive, see \ref
+ * ::ark::net::tcp::coro::receive_multishot and \ref ::ark::multishot_stream
+ */
+using receive_stream = multishot_stream<socket, leased_buffer>;
+
+/*!
+ * \brief receive from the socket until eof with a single multishot receive
+ *
+ * returns a stream, whose next() yields each chunk received, and an empty
+ * buffer on eof, see \ref ::ark::net::tcp::async::receive_multishot
+ *
+ * \code
+ * auto stream = tcp::coro::receive_multishot(s);
+ * for (;;) {
+ *   leased_buffer b = CoTryX(co_await stream.next());
+ *   if (b.size() == 0)
+ *     break;
+ *   ...
+ * }
+ * \endcode
+ */
+inline receive_stream receive_multishot(socket &s) noexcept {
+  return receive_stream(
+      s, [](socket &s, callback<result<leased_buffer>> &&cb) {
+        return async::receive_multishot(
+            s, forward<callback<result<leased_buffer>>>(cb));
+      });
+}
+
+/*!
+ * \brief relay the bytes between two connected sockets in both directions,
+ * without copying them to user space, until both of them reached eof
+ *
+ * returns an Awaitable which yields an result<void> when co_awaited, once both
+ * directions ended, see \ref ::ark::net::tcp::async::relay
+ */
+inline auto relay(socket &a, socket &b, relay_counters &counters) noexcept {
+  return relay_awaitable(a, b, counters);
+}
+
+/*!
+ * \brief send up to len bytes of the file to the socket, starting from the
+ * offset of the file, without copying them to user space
+ *
+ * returns an Awaitable which yields the number of bytes sent as an
+ * result<size_t> when co_awaited, see \ref
+ * ::ark::net::tcp::async::transfer_file
+ */
+inline auto transfer_file(normal_file &f, size_t len, socket &s) noexcept {
+  return transfer_file_awaitable(f, nullopt, len, s);
+}
+
+/*!
+ * \brief send up to len bytes of the file, starting from off, to the socket
+ *
+ * returns an Awaitable which yields the number of bytes sent as an
+ * result<size_t> when co_awaited, see \ref
+ * ::ark::net::tcp::async::transfer_file
+ */
+inline auto transfer_file(normal_file &f, clinux::off_t off, size_t len,
+                          socket &s) noexcept {
+  return transfer_file_awaitable(f, off, len, s);
+}
+
 } // namespace coro
 } // namespace tcp
 
@@ -46,6 +46,28 @@ inline result<void> listen(acceptor &f,
   return success();
 }
 
+/*!
+ * \brief allow multiple acceptors to bind to the same endpoint
+ *
+ * sets SO_REUSEPORT, see socket(7). Incoming connections are then distributed
+ * among the acceptors by the kernel, which is handy for serving one endpoint
+ * with several \ref ::ark::async_context, e.g. from an \ref
+ * ::ark::async_context_pool
+ *
+ * \pre must get called before bind
+ *
+ * won't block
+ */
+inline result<void> reuse_port(acceptor &f, bool enable = true) noexcept {
+  int v = enable ? 1 : 0;
+  int ret =
+      clinux::setsockopt(f.get(), SOL_SOCKET, SO_REUSEPORT, &v, sizeof(v));
+  if (ret == -1) {
+    return errno_ec();
+  }
+  return success();
+}
+
 } // namespace tcp
 
 /*! @} */
@@ -19,6 +19,9 @@ class socket;
 
 inline socket wrap_accepted_socket(async_context *ctx, int fd) noexcept;
 
+inline socket wrap_accepted_direct_socket(async_context &ctx,
+                                          int fixed) noexcept;
+
 /*! \endcond */
 
 /*!
@@ -37,7 +40,57 @@ protected:
    */
   socket(int fd_int) : fd(fd_int) {}
 
+  /*!
+   * \brief constructs from a slot of the registered file table of ctx
+   */
+  socket(int fixed, async_context &ctx) : fd(fixed, ctx) {}
+
 private:
+  // kept apart, as the timer wheel links to it. Only the loop thread of ctx_
+  // arms, disarms and frees it, see release_idle()
+  struct idle_type {
+    async_context &ctx_;
+    async_context::timer_entry e_;
+    // 0 till the arming dispatched to the loop ran
+    chrono::nanoseconds timeout_{0};
+    // the file cancelled on expiration, kept up to date by the socket as the
+    // entry expires on the loop thread. slot_ is -1 unless registered
+    atomic<int> fd_;
+    atomic<int> slot_;
+
+    idle_type(async_context &ctx, int fd, int slot) noexcept
+        : ctx_(ctx), fd_(fd), slot_(slot) {
+      e_.set_callback([this]() { reap(); });
+    }
+
+    void reap() noexcept {
+      int slot = slot_.load();
+      if (slot != -1) {
+        static_cast<void>(ctx_.cancel_fd({slot, true}));
+        return;
+      }
+      int fd = fd_.load();
+      if (fd != -1)
+        static_cast<void>(ctx_.cancel_fd(fd));
+    }
+  };
+  unique_ptr<idle_type> idle_;
+
+  // bumped on each cancellation of the io operations on the socket, which
+  // multishot operations check before re-arming
+  atomic<unsigned> cancels_{0};
+
+  // hands the idle timeout over to the loop, which disarms and frees it
+  void release_idle() noexcept {
+    if (!idle_)
+      return;
+    idle_->fd_.store(-1);
+    idle_->slot_.store(-1);
+    auto &ctx = idle_->ctx_;
+    static_cast<void>(
+        ctx.dispatch([idle = move(idle_)]() mutable { idle.reset(); }));
+  }
+
   static result<socket> __create(async_context *ctx,
                                  bool use_ipv6 = false) noexcept {
     int ret = clinux::socket(use_ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
@@ -50,11 +103,31 @@ private:
   }
 
 public:
+  /*! \cond HIDDEN_CLASSES */
+  static constexpr bool stream_socket = true;
+  /*! \endcond */
+
   /*! \cond SOCKET_WRAP_INTERNALS */
   friend inline socket wrap_accepted_socket(async_context *ctx,
                                             int fd) noexcept;
+  friend inline socket wrap_accepted_direct_socket(async_context &ctx,
+                                                   int fixed) noexcept;
   /*! \endcond */
 
+  socket(socket &&other) noexcept
+      : fd(move(other)), idle_(move(other.idle_)),
+        cancels_(other.cancels_.load()) {}
+
+  socket &operator=(socket &&other) noexcept {
+    release_idle();
+    fd::operator=(move(other));
+    idle_ = move(other.idle_);
+    cancels_.store(other.cancels_.load());
+    return *this;
+  }
+
+  ~socket() noexcept { release_idle(); }
+
   /*!
    * \brief constructs a socket available for connecting
    *
@@ -76,6 +149,72 @@ public:
                                bool use_ipv6 = false) noexcept {
     return __create(&ctx, use_ipv6);
   }
+
+  /*!
+   * \brief reaps the socket once none of its io operations completed for
+   * timeout
+   *
+   * on expiration, the io operations in flight on the socket are cancelled, see
+   * \ref ::ark::async::cancel. The timeout is kept on the timer wheel of the
+   * bound context, see \ref ::ark::wheel_timer, and is re-armed on completion
+   * of each async read or write, which costs neither allocation nor syscall. A
+   * zero timeout disarms it.
+   *
+   * \pre bound to an async_context. Could be called from any thread, the
+   * timeout is armed on the thread running the context
+   */
+  void set_idle_timeout(chrono::nanoseconds timeout) noexcept {
+    if (timeout == timeout.zero())
+      return release_idle();
+    if (!idle_)
+      idle_ = make_unique<idle_type>(context(), get(), fixed());
+    static_cast<void>(
+        context().dispatch([idle = idle_.get(), timeout]() {
+          idle->timeout_ = timeout;
+          idle->ctx_.arm_timer(idle->e_, timeout);
+        }));
+  }
+
+  /*!
+   * \brief re-arms the idle timeout, if set
+   *
+   * invoked on completion of each async read or write, on the thread running
+   * the bound context
+   */
+  void refresh_idle_timeout() noexcept {
+    if (idle_ && idle_->timeout_ != idle_->timeout_.zero())
+      context().arm_timer(idle_->e_, idle_->timeout_);
+  }
+
+  /*!
+   * \brief installs the socket into the registered file table of the bound
+   * context, see \ref ::ark::fd::register_file
+   */
+  result<void> register_file() noexcept {
+    OUTCOME_TRY(fd::register_file());
+    if (idle_)
+      idle_->slot_.store(fixed());
+    return success();
+  }
+
+  /*!
+   * \brief disarms the idle timeout, then closes the socket, see \ref
+   * ::ark::fd::close
+   */
+  result<void> close() noexcept {
+    release_idle();
+    count_cancel();
+    return fd::close();
+  }
+
+  /*! \cond HIDDEN_CLASSES */
+
+  // see \ref ::ark::async::cancel
+  void count_cancel() noexcept { cancels_.fetch_add(1); }
+
+  unsigned cancels() const noexcept { return cancels_.load(); }
+
+  /*! \endcond */
 };
 
 /*! \cond SOCKET_WRAP_INTERNALS */
@@ -86,6 +225,13 @@ inline socket wrap_accepted_socket(async_context *ctx, int fd) noexcept {
   return move(ret);
 }
 
+inline socket wrap_accepted_direct_socket(async_context &ctx,
+                                          int fixed) noexcept {
+  socket ret(fixed, ctx);
+  ret.set_async_context(&ctx);
+  return move(ret);
+}
+
 /*! \endcond */
 } // namespace tcp
 
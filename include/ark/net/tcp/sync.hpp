@@ -2,6 +2,7 @@
 
 #include <ark/bindings.hpp>
 
+#include <ark/general/normal_file.hpp>
 #include <ark/net/address.hpp>
 #include <ark/net/tcp/acceptor.hpp>
 #include <ark/net/tcp/socket.hpp>
@@ -20,6 +21,13 @@ namespace tcp {
  */
 namespace sync {
 
+/*! \cond HIDDEN_CLASSES */
+
+// the size asked for the pipe transfer_file() splices through
+static const constexpr size_t transfer_pipe_size = 256 * 1024;
+
+/*! \endcond */
+
 /*!
  * \brief connect socket to the given endpoint
  *
@@ -62,6 +70,62 @@ inline result<socket> accept(acceptor &srv, address &endpoint) noexcept {
   }
   return wrap_accepted_socket(nullptr, ret);
 }
+
+/*!
+ * \brief send up to len bytes of the file to the socket, starting from the
+ * offset of the file, without copying them to user space, as sendfile(2)
+ *
+ * blocks until complete or error, returns the number of bytes sent, less than
+ * len only if the end of the file is reached. The bytes are spliced through a
+ * pipe of 256KiB created for the call, or of the size allowed by
+ * /proc/sys/fs/pipe-max-size. The offset of the file is advanced by the bytes
+ * sent, even on error.
+ *
+ * fails with EBADF on sockets living only in the registered file table, see
+ * \ref ::ark::net::tcp::acceptor::set_direct_accept
+ */
+inline result<size_t> transfer_file(normal_file &f, size_t len,
+                                    socket &s) noexcept {
+  if (s.get() == -1)
+    return as_ec(EBADF);
+  auto p = io_uring_async::kernel_pipe::create(transfer_pipe_size);
+  if (!p)
+    return p.as_failure();
+  auto &pipe = p.value();
+  size_t done = 0;
+  while (done < len) {
+    clinux::loff_t off = f.offset();
+    auto read_ret = clinux::splice(f.get(), addressof(off), pipe.wr_, nullptr,
+                                   min(len - done, pipe.size_), SPLICE_F_MOVE);
+    if (read_ret == -1)
+      return errno_ec();
+    if (read_ret == 0) // eof
+      break;
+    auto left = static_cast<size_t>(read_ret);
+    while (left != 0) {
+      unsigned flags = done + left < len ? SPLICE_F_MORE : 0;
+      auto write_ret = clinux::splice(pipe.rd_, nullptr, s.get(), nullptr,
+                                      left, SPLICE_F_MOVE | flags);
+      if (write_ret == -1)
+        return errno_ec();
+      f.feed(write_ret);
+      left -= static_cast<size_t>(write_ret);
+      done += static_cast<size_t>(write_ret);
+    }
+  }
+  return done;
+}
+
+/*!
+ * \brief send up to len bytes of the file, starting from off, to the socket
+ *
+ * same as seeking the file to off, then transfer_file(f, len, s)
+ */
+inline result<size_t> transfer_file(normal_file &f, clinux::off_t off,
+                                    size_t len, socket &s) noexcept {
+  f.seek(off);
+  return transfer_file(f, len, s);
+}
 } // namespace sync
 } // namespace tcp
 
@@ -0,0 +1,20 @@
+#pragma once
+
+namespace ark {
+namespace net {
+/*!
+ * \brief implements UDP/IP related classes and functions
+ */
+namespace udp {}
+} // namespace net
+} // namespace ark
+
+#include <ark/net/udp/socket.hpp>
+
+#include <ark/net/udp/general.hpp>
+
+#include <ark/net/udp/async.hpp>
+#include <ark/net/udp/sync.hpp>
+#ifndef ARK_NO_COROUTINES
+#include <ark/net/udp/coro.hpp>
+#endif
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async/context.hpp>
+#include <ark/buffer.hpp>
+#include <ark/net/address.hpp>
+#include <ark/net/udp/message.hpp>
+#include <ark/net/udp/socket.hpp>
+
+namespace ark {
+namespace net {
+
+/*! \addtogroup net
+ *  @{
+ */
+
+namespace udp {
+
+/*!
+ * \brief contains apis that invokes a given \ref ::ark::callback on completion
+ */
+namespace async {
+
+/*!
+ * \brief send the buffer as a datagram to the given endpoint
+ *
+ * returns instantly, cb is invoked on completion or error, with the number of
+ * bytes sent. Done with IORING_OP_SENDMSG. If segment_size is not 0, the
+ * buffer is sent as datagrams of segment_size bytes with a single operation,
+ * see \ref ::ark::net::udp::set_segment_size. The buffer must outlive the
+ * operation, the endpoint is copied.
+ */
+template <concepts::ConstBufferSequence ConstBufferSequence>
+inline void send_to(socket &f, const ConstBufferSequence &b,
+                    const address &endpoint, uint16_t segment_size,
+                    callback<result<size_t>> &&cb) noexcept {
+  auto m = make_unique<message>(b);
+  auto *msg = m->for_send(endpoint, segment_size);
+  auto ret = async_syscall::sendmsg(
+      f.context(), sqe_file_of(f), msg, 0,
+      [m = move(m), cb(forward<callback<result<size_t>>>(cb))](
+          result<long> ret) mutable {
+        if (!ret)
+          return cb(ret.error());
+        cb(static_cast<size_t>(ret.value()));
+      });
+  if (!ret)
+    cb(ret.error());
+}
+
+/*!
+ * \brief send the buffer as a datagram to the given endpoint
+ *
+ * same as send_to(f, b, endpoint, 0, cb)
+ */
+template <concepts::ConstBufferSequence ConstBufferSequence>
+inline void send_to(socket &f, const ConstBufferSequence &b,
+                    const address &endpoint,
+                    callback<result<size_t>> &&cb) noexcept {
+  send_to(f, b, endpoint, 0, forward<callback<result<size_t>>>(cb));
+}
+
+/*!
+ * \brief receive a datagram into the buffer
+ *
+ * returns instantly, cb is invoked on completion or error. Done with
+ * IORING_OP_RECVMSG. The buffer and endpoint must outlive the operation.
+ *
+ * \param[out] endpoint the address of the sender, on success
+ */
+template <concepts::MutableBufferSequence MutableBufferSequence>
+inline void receive_from(socket &f, const MutableBufferSequence &b,
+                         address &endpoint,
+                         callback<result<receive_info>> &&cb) noexcept {
+  auto m = make_unique<message>(b);
+  auto *msg = m->for_receive();
+  auto ret = async_syscall::recvmsg(
+      f.context(), sqe_file_of(f), msg, 0,
+      [m = move(m), &endpoint, cb(forward<callback<result<receive_info>>>(cb))](
+          result<long> ret) mutable {
+        if (!ret)
+          return cb(ret.error());
+        endpoint = m->addr_;
+        cb(m->received(static_cast<size_t>(ret.value())));
+      });
+  if (!ret)
+    cb(ret.error());
+}
+
+} // namespace async
+} // namespace udp
+
+/*! @} */
+
+} // namespace net
+} // namespace ark
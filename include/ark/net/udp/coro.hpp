@@ -0,0 +1,95 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async/context.hpp>
+#include <ark/coroutine/awaitable_op.hpp>
+#include <ark/net/address.hpp>
+#include <ark/net/udp/async.hpp>
+#include <ark/net/udp/socket.hpp>
+
+namespace ark {
+namespace net {
+
+/*! \addtogroup net
+ *  @{
+ */
+
+namespace udp {
+
+/*!
+ * \brief contains apis that returns an Awaitable
+ */
+namespace coro {
+
+/*! \cond HIDDEN_CLASSES */
+
+template <concepts::ConstBufferSequence ConstBufferSequence>
+struct send_to_awaitable : public awaitable_op<result<size_t>> {
+  socket &f_;
+  const ConstBufferSequence &b_;
+  const address &endpoint_;
+  uint16_t segment_size_;
+
+  send_to_awaitable(socket &f, const ConstBufferSequence &b,
+                    const address &endpoint, uint16_t segment_size) noexcept
+      : f_(f), b_(b), endpoint_(endpoint), segment_size_(segment_size) {}
+
+  void invoke(callback<result<size_t>> &&cb) noexcept override {
+    async::send_to(f_, b_, endpoint_, segment_size_,
+                   forward<callback<result<size_t>>>(cb));
+  }
+};
+
+template <concepts::MutableBufferSequence MutableBufferSequence>
+struct receive_from_awaitable : public awaitable_op<result<receive_info>> {
+  socket &f_;
+  const MutableBufferSequence &b_;
+  address &endpoint_;
+
+  receive_from_awaitable(socket &f, const MutableBufferSequence &b,
+                         address &endpoint) noexcept
+      : f_(f), b_(b), endpoint_(endpoint) {}
+
+  void invoke(callback<result<receive_info>> &&cb) noexcept override {
+    async::receive_from(f_, b_, endpoint_,
+                        forward<callback<result<receive_info>>>(cb));
+  }
+};
+
+/*! \endcond */
+
+/*!
+ * \brief send the buffer as a datagram to the given endpoint
+ *
+ * returns an Awaitable which yields the number of bytes sent as an
+ * result<size_t> when co_awaited, see \ref ::ark::net::udp::async::send_to
+ */
+template <concepts::ConstBufferSequence ConstBufferSequence>
+inline auto send_to(socket &f, const ConstBufferSequence &b,
+                    const address &endpoint,
+                    uint16_t segment_size = 0) noexcept {
+  return send_to_awaitable<ConstBufferSequence>(f, b, endpoint, segment_size);
+}
+
+/*!
+ * \brief receive a datagram into the buffer
+ *
+ * returns an Awaitable which yields an result<receive_info> when co_awaited,
+ * see \ref ::ark::net::udp::async::receive_from
+ *
+ * \param[out] endpoint the address of the sender, on success
+ */
+template <concepts::MutableBufferSequence MutableBufferSequence>
+inline auto receive_from(socket &f, const MutableBufferSequence &b,
+                         address &endpoint) noexcept {
+  return receive_from_awaitable<MutableBufferSequence>(f, b, endpoint);
+}
+
+} // namespace coro
+} // namespace udp
+
+/*! @} */
+
+} // namespace net
+} // namespace ark
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/net/address.hpp>
+#include <ark/net/udp/socket.hpp>
+
+namespace ark {
+namespace net {
+
+/*! \addtogroup net
+ *  @{
+ */
+
+namespace udp {
+
+/*!
+ * \brief bind socket to the given endpoint, to receive the datagrams sent to
+ * it
+ *
+ * see bind(2)
+ *
+ * won't block
+ */
+inline result<void> bind(socket &f, const address &endpoint) noexcept {
+  int ret = clinux::bind(f.get(), endpoint.sa_ptr(), endpoint.sa_len());
+  if (ret == -1) {
+    return errno_ec();
+  }
+  return success();
+}
+
+/*!
+ * \brief let the kernel split each send into datagrams of segment_size bytes
+ *
+ * sets UDP_SEGMENT, see udp(7), so that a single send of up to 64KiB carries
+ * dozens of datagrams to the same destination, which are segmented as late as
+ * possible, by the nic if it supports it (GSO). 0 turns it off. The segment
+ * size could be given per send as well, e.g. \ref
+ * ::ark::net::udp::async::send_to. Requires kernel >= 4.18.
+ *
+ * won't block
+ */
+inline result<void> set_segment_size(socket &f,
+                                     uint16_t segment_size) noexcept {
+  int v = segment_size;
+  int ret = clinux::setsockopt(f.get(), SOL_UDP, UDP_SEGMENT, &v, sizeof(v));
+  if (ret == -1) {
+    return errno_ec();
+  }
+  return success();
+}
+
+/*!
+ * \brief let the kernel coalesce the datagrams received from the same sender
+ *
+ * sets UDP_GRO, see udp(7), so that a single receive gets several datagrams
+ * of the same size back to back, their size is reported in \ref
+ * ::ark::net::udp::receive_info::segment_size. The buffers received into
+ * should then be 64KiB. Requires kernel >= 5.0.
+ *
+ * won't block
+ */
+inline result<void> enable_gro(socket &f, bool enable = true) noexcept {
+  int v = enable ? 1 : 0;
+  int ret = clinux::setsockopt(f.get(), SOL_UDP, UDP_GRO, &v, sizeof(v));
+  if (ret == -1) {
+    return errno_ec();
+  }
+  return success();
+}
+
+} // namespace udp
+
+/*! @} */
+
+} // namespace net
+} // namespace ark
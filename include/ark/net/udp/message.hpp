@@ -0,0 +1,83 @@
+#pragma once
+
+/*! \cond FILE_NOT_DOCUMENTED */
+
+#include <cstring>
+
+#include <ark/bindings.hpp>
+
+#include <ark/buffer.hpp>
+#include <ark/io/iovecs.hpp>
+#include <ark/net/address.hpp>
+#include <ark/net/udp/socket.hpp>
+
+namespace ark {
+namespace net {
+namespace udp {
+
+// a msghdr with everything it points to, kept at a stable address till the
+// sendmsg / recvmsg completed
+struct message {
+  vector<clinux::iovec> iov_;
+  address addr_;
+  clinux::msghdr msg_{};
+  // room for either UDP_SEGMENT or UDP_GRO
+  alignas(clinux::cmsghdr) array<char, CMSG_SPACE(sizeof(int))> control_{};
+
+  template <class BufferSequence>
+  message(const BufferSequence &b) noexcept
+      : iov_(to_iovecs(b, 0, buffer_size(b))) {}
+
+  // with UDP_SEGMENT, unless segment_size is 0, so that the kernel splits the
+  // buffer into datagrams of segment_size bytes
+  clinux::msghdr *for_send(const address &to,
+                           uint16_t segment_size) noexcept {
+    addr_ = to;
+    msg_ = {};
+    msg_.msg_name = addr_.sa_ptr();
+    msg_.msg_namelen = addr_.sa_len();
+    msg_.msg_iov = iov_.data();
+    msg_.msg_iovlen = iov_.size();
+    if (segment_size == 0)
+      return addressof(msg_);
+    msg_.msg_control = control_.data();
+    msg_.msg_controllen = CMSG_SPACE(sizeof(segment_size));
+    auto *cm = CMSG_FIRSTHDR(addressof(msg_));
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(segment_size));
+    std::memcpy(CMSG_DATA(cm), &segment_size, sizeof(segment_size));
+    return addressof(msg_);
+  }
+
+  clinux::msghdr *for_receive() noexcept {
+    msg_ = {};
+    msg_.msg_name = addr_.sa_ptr();
+    msg_.msg_namelen = addr_.sa_len();
+    msg_.msg_iov = iov_.data();
+    msg_.msg_iovlen = iov_.size();
+    msg_.msg_control = control_.data();
+    msg_.msg_controllen = control_.size();
+    return addressof(msg_);
+  }
+
+  // once recvmsg returned sz, the sender is left in addr_
+  receive_info received(size_t sz) noexcept {
+    receive_info ret{sz, sz, (msg_.msg_flags & MSG_TRUNC) != 0};
+    for (auto *cm = CMSG_FIRSTHDR(addressof(msg_)); cm != nullptr;
+         cm = CMSG_NXTHDR(addressof(msg_), cm)) {
+      if (cm->cmsg_level != SOL_UDP || cm->cmsg_type != UDP_GRO)
+        continue;
+      int gso_size;
+      std::memcpy(&gso_size, CMSG_DATA(cm), sizeof(gso_size));
+      ret.segment_size = static_cast<size_t>(gso_size);
+    }
+    return ret;
+  }
+};
+
+} // namespace udp
+} // namespace net
+} // namespace ark
+
+/*! \endcond */
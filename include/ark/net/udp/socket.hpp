@@ -0,0 +1,96 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/io/fd.hpp>
+
+namespace ark {
+namespace net {
+
+/*! \addtogroup net
+ *  @{
+ */
+
+namespace udp {
+
+/*!
+ * \brief denotes a udp socket
+ *
+ * available for sending right after creation, and for receiving once bound,
+ * see \ref ::ark::net::udp::bind
+ */
+class socket : public fd {
+protected:
+  /*!
+   * \brief constructs from int fildes
+   *
+   * \param[in] fd_int must be an fildes opened by socket(2)
+   */
+  socket(int fd_int) : fd(fd_int) {}
+
+private:
+  static result<socket> __create(async_context *ctx,
+                                 bool use_ipv6 = false) noexcept {
+    int ret = clinux::socket(use_ipv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, 0);
+    if (ret == -1) {
+      return errno_ec();
+    }
+    socket ret_fd(ret);
+    ret_fd.set_async_context(ctx);
+    return move(ret_fd);
+  }
+
+public:
+  /*!
+   * \brief constructs a udp socket
+   *
+   * \param[in] use_ipv6 if set to true, the addresses used with it should be
+   * \ref ark::net::inet6_address
+   */
+  static result<socket> create(bool use_ipv6 = false) noexcept {
+    return __create(nullptr, use_ipv6);
+  }
+
+  /*!
+   * \brief constructs a udp socket bound to the given \ref ark::async_context
+   *
+   * \param[in] use_ipv6 if set to true, the addresses used with it should be
+   * \ref ark::net::inet6_address
+   */
+  static result<socket> create(async_context &ctx,
+                               bool use_ipv6 = false) noexcept {
+    return __create(&ctx, use_ipv6);
+  }
+};
+
+/*!
+ * \brief what a receive from a udp socket got
+ */
+struct receive_info {
+  /*!
+   * \brief bytes received
+   */
+  size_t size{0};
+
+  /*!
+   * \brief the size of each datagram received
+   *
+   * with GRO enabled, see \ref ::ark::net::udp::enable_gro, several datagrams
+   * of the same sender might be received at once, laid out back to back, each
+   * of segment_size bytes but the last one which might be shorter. Equal to
+   * size otherwise.
+   */
+  size_t segment_size{0};
+
+  /*!
+   * \brief the datagram did not fit into the buffer, and got truncated
+   */
+  bool truncated{false};
+};
+
+} // namespace udp
+
+/*! @} */
+
+} // namespace net
+} // namespace ark
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/buffer.hpp>
+#include <ark/net/address.hpp>
+#include <ark/net/udp/message.hpp>
+#include <ark/net/udp/socket.hpp>
+
+namespace ark {
+namespace net {
+
+/*! \addtogroup net
+ *  @{
+ */
+
+namespace udp {
+
+/*!
+ * \brief contains apis that blocks until completion
+ */
+namespace sync {
+
+/*!
+ * \brief a datagram of a batch to send, see \ref send_batch
+ */
+struct send_slot {
+  /*!
+   * \brief the payload, must outlive the send
+   */
+  const_buffer buf;
+
+  /*!
+   * \brief where the datagram goes
+   */
+  address endpoint;
+};
+
+/*!
+ * \brief room for a datagram of a batch to receive, see \ref receive_batch
+ */
+struct receive_slot {
+  /*!
+   * \brief where the payload is received into
+   */
+  mutable_buffer buf;
+
+  /*!
+   * \brief the sender, once received
+   */
+  address endpoint;
+
+  /*!
+   * \brief what got received, segment_size is always equal to size
+   */
+  receive_info info;
+};
+
+/*! \cond HIDDEN_CLASSES */
+
+// slots are handed to the kernel in chunks of this many, so that the headers
+// could live on the stack
+constexpr size_t batch_chunk = 64;
+
+/*! \endcond */
+
+/*!
+ * \brief send the buffer as a datagram to the given endpoint
+ *
+ * blocks until complete or error, returns the number of bytes sent. If
+ * segment_size is not 0, the buffer is sent as datagrams of segment_size bytes
+ * with a single syscall, see \ref ::ark::net::udp::set_segment_size.
+ */
+template <concepts::ConstBufferSequence ConstBufferSequence>
+inline result<size_t> send_to(socket &f, const ConstBufferSequence &b,
+                              const address &endpoint,
+                              uint16_t segment_size = 0) noexcept {
+  message m{b};
+  auto ret = clinux::sendmsg(f.get(), m.for_send(endpoint, segment_size), 0);
+  if (ret == -1) {
+    return errno_ec();
+  }
+  return static_cast<size_t>(ret);
+}
+
+/*!
+ * \brief receive a datagram into the buffer
+ *
+ * blocks until complete or error.
+ *
+ * \param[out] endpoint the address of the sender, on success
+ */
+template <concepts::MutableBufferSequence MutableBufferSequence>
+inline result<receive_info> receive_from(socket &f,
+                                         const MutableBufferSequence &b,
+                                         address &endpoint) noexcept {
+  message m{b};
+  auto ret = clinux::recvmsg(f.get(), m.for_receive(), 0);
+  if (ret == -1) {
+    return errno_ec();
+  }
+  endpoint = m.addr_;
+  return m.received(static_cast<size_t>(ret));
+}
+
+/*!
+ * \brief send a datagram per slot with as few syscalls as possible
+ *
+ * blocks until all are sent or error, done with sendmmsg(2), which is invoked
+ * once per 64 slots. Returns the number of slots sent, those after it are not
+ * sent. An error is only returned if none could be sent.
+ */
+inline result<size_t> send_batch(socket &f,
+                                 span<const send_slot> slots) noexcept {
+  array<clinux::mmsghdr, batch_chunk> hdrs;
+  array<clinux::iovec, batch_chunk> iovs;
+  array<address, batch_chunk> addrs;
+  size_t done = 0;
+  while (done < slots.size()) {
+    size_t n = min(slots.size() - done, batch_chunk);
+    for (size_t i = 0; i < n; i++) {
+      const send_slot &slot = slots[done + i];
+      iovs[i].iov_base = const_cast<char *>(slot.buf.data());
+      iovs[i].iov_len = slot.buf.size();
+      addrs[i] = slot.endpoint;
+      hdrs[i] = {};
+      hdrs[i].msg_hdr.msg_name = addrs[i].sa_ptr();
+      hdrs[i].msg_hdr.msg_namelen = addrs[i].sa_len();
+      hdrs[i].msg_hdr.msg_iov = addressof(iovs[i]);
+      hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int ret = clinux::sendmmsg(f.get(), hdrs.data(), n, 0);
+    if (ret == -1) {
+      if (done == 0)
+        return errno_ec();
+      break;
+    }
+    done += ret;
+    if (static_cast<size_t>(ret) < n)
+      break;
+  }
+  return done;
+}
+
+/*!
+ * \brief receive a datagram per slot with as few syscalls as possible
+ *
+ * blocks until at least one datagram is received or error, then takes the ones
+ * already queued on the socket without blocking, till the slots are full. Done
+ * with recvmmsg(2), which is invoked once per 64 slots. Returns the number of
+ * slots filled, from the first one.
+ */
+inline result<size_t> receive_batch(socket &f,
+                                    span<receive_slot> slots) noexcept {
+  array<clinux::mmsghdr, batch_chunk> hdrs;
+  array<clinux::iovec, batch_chunk> iovs;
+  size_t done = 0;
+  while (done < slots.size()) {
+    size_t n = min(slots.size() - done, batch_chunk);
+    for (size_t i = 0; i < n; i++) {
+      receive_slot &slot = slots[done + i];
+      iovs[i].iov_base = slot.buf.data();
+      iovs[i].iov_len = slot.buf.size();
+      hdrs[i] = {};
+      hdrs[i].msg_hdr.msg_name = slot.endpoint.sa_ptr();
+      hdrs[i].msg_hdr.msg_namelen = slot.endpoint.sa_len();
+      hdrs[i].msg_hdr.msg_iov = addressof(iovs[i]);
+      hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int flags = done == 0 ? MSG_WAITFORONE : MSG_DONTWAIT;
+    int ret = clinux::recvmmsg(f.get(), hdrs.data(), n, flags, nullptr);
+    if (ret == -1) {
+      if (done == 0)
+        return errno_ec();
+      break;
+    }
+    for (int i = 0; i < ret; i++) {
+      auto &info = slots[done + i].info;
+      info.size = info.segment_size = hdrs[i].msg_len;
+      info.truncated = (hdrs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+    done += ret;
+    if (static_cast<size_t>(ret) < n)
+      break;
+  }
+  return done;
+}
+
+} // namespace sync
+} // namespace udp
+
+/*! @} */
+
+} // namespace net
+} // namespace ark
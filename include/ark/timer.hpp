@@ -0,0 +1,21 @@
+#pragma once
+
+/*! \addtogroup timer
+ *  \brief This module provides timers.
+ *
+ * Timers are io objects which could be waited on in the same three flavors as
+ * io functions, \ref ::ark::sync, \ref ::ark::async and \ref ::ark::coro.
+ * Async waits are native timeouts of the ring rather than timerfds.
+ *
+ * For the many timeouts which are mostly re-armed before expiring, \ref
+ * ::ark::wheel_timer costs no syscall at all.
+ */
+
+#include <ark/timer/async.hpp>
+#include <ark/timer/steady_timer.hpp>
+#include <ark/timer/sync.hpp>
+#include <ark/timer/wheel_timer.hpp>
+
+#ifndef ARK_NO_COROUTINES
+#include <ark/timer/coro.hpp>
+#endif
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async/async_op.hpp>
+#include <ark/async/context.hpp>
+#include <ark/timer/steady_timer.hpp>
+
+namespace ark {
+
+/*! \addtogroup timer
+ *  @{
+ */
+
+namespace async {
+
+/*! \cond HIDDEN_CLASSES */
+
+inline bool is_timer_expired(const result<long> &ret) noexcept {
+  return ret.has_value() || ret.error().value() == ETIME;
+}
+
+struct timer_wait_impl {
+  struct locals_t {
+    steady_timer &t_;
+    // read by the kernel on submission
+    clinux::__kernel_timespec ts_;
+    async_context::token_t tok_{};
+
+    locals_t(steady_timer &t) noexcept
+        : t_(t), ts_(to_kernel_timespec(t.expiry().time_since_epoch())) {}
+  };
+  using ret_t = result<void>;
+  using op_t = async_op<timer_wait_impl>;
+
+  static void run(op_t &op) noexcept {
+    auto &ctx = op.ctx_;
+    auto p_locals = op.locals_.get();
+    auto ret = async_syscall::timeout(
+        ctx, addressof(p_locals->ts_), IORING_TIMEOUT_ABS,
+        op.yield_syscall(timer_wait_impl::finish));
+    if (ret.has_error())
+      return op.complete(ret.as_failure());
+    p_locals->tok_ = ret.value();
+    p_locals->t_.base().pending_.push_back(ret.value());
+  }
+
+  static void finish(op_t &op, result<long> ret) noexcept {
+    op.locals_->t_.base().untrack(op.locals_->tok_);
+    if (!is_timer_expired(ret))
+      return op.complete(ret.error());
+    op.complete(success());
+  }
+};
+
+// the state is kept in the timer, as the periodic wait goes on across
+// completions
+struct timer_tick_impl {
+  using base_type = steady_timer::base_type;
+
+  static result<void> arm(async_context &ctx, base_type &b) noexcept {
+#ifdef IORING_TIMEOUT_MULTISHOT
+    if (b.multishot_) {
+      b.tick_ts_ = to_kernel_timespec(b.period_);
+      auto ret = async_syscall::timeout_multishot(
+          ctx, addressof(b.tick_ts_), IORING_TIMEOUT_MULTISHOT,
+          [&ctx, &b](result<long> ret, bool more) {
+            on_multishot(ctx, b, ret, more);
+          });
+      if (ret.has_error())
+        return ret.as_failure();
+      b.tick_tok_ = ret.value();
+      b.pending_.push_back(ret.value());
+      return success();
+    }
+#endif
+    // absolute deadlines, so that the ticks do not drift
+    b.next_tick_ += b.period_;
+    b.tick_ts_ = to_kernel_timespec(b.next_tick_.time_since_epoch());
+    auto ret = async_syscall::timeout(
+        ctx, addressof(b.tick_ts_), IORING_TIMEOUT_ABS,
+        [&ctx, &b](result<long> ret) { on_tick(ctx, b, ret); });
+    if (ret.has_error())
+      return ret.as_failure();
+    b.tick_tok_ = ret.value();
+    b.pending_.push_back(ret.value());
+    return success();
+  }
+
+  static void on_tick(async_context &ctx, base_type &b,
+                      result<long> ret) noexcept {
+    b.untrack(b.tick_tok_);
+    if (!is_timer_expired(ret))
+      return finish(b, ret.error());
+    // re-armed before the callback, so that cancel() from within it works
+    auto arm_ret = arm(ctx, b);
+    if (arm_ret.has_error())
+      return finish(b, arm_ret.error());
+    b.tick_cb_(success());
+  }
+
+#ifdef IORING_TIMEOUT_MULTISHOT
+  static void on_multishot(async_context &ctx, base_type &b, result<long> ret,
+                           bool more) noexcept {
+    if (!more)
+      b.untrack(b.tick_tok_);
+    if (!is_timer_expired(ret)) {
+      // multishot timeouts require kernel >= 6.4, fall back to re-arming
+      if (!more && ret.error().value() == EINVAL && b.multishot_) {
+        b.multishot_ = false;
+        b.next_tick_ = steady_timer::clock::now();
+        auto arm_ret = arm(ctx, b);
+        if (arm_ret.has_error())
+          finish(b, arm_ret.error());
+        return;
+      }
+      return finish(b, ret.error());
+    }
+    if (!more) {
+      auto arm_ret = arm(ctx, b);
+      if (arm_ret.has_error())
+        return finish(b, arm_ret.error());
+    }
+    b.tick_cb_(success());
+  }
+#endif
+
+  static void finish(base_type &b, error_code ec) noexcept {
+    auto cb = move(b.tick_cb_);
+    cb(ec);
+  }
+};
+
+/*! \endcond */
+
+/*!
+ * \brief wait until the expiry of the timer
+ *
+ * returns instantly, cb is invoked once the timer expired, or with ECANCELED
+ * if \ref ::ark::steady_timer::cancel was called before that.
+ */
+inline void wait(steady_timer &t, callback<result<void>> &&cb) noexcept {
+  using impl_t = timer_wait_impl;
+  async_op<impl_t>(t.context(), forward<callback<result<void>>>(cb),
+                   make_unique<typename impl_t::locals_t>(t))
+      .run();
+}
+
+/*!
+ * \brief tick periodically, starting one period from now
+ *
+ * returns instantly, cb is invoked on each tick with success, until \ref
+ * ::ark::steady_timer::cancel is called, after which it is invoked for the
+ * last time with ECANCELED. The expiry of the timer is not used.
+ *
+ * The ticks are a single multishot timeout of the ring on linux kernel >= 6.4,
+ * or re-armed on each tick otherwise, without drifting. Only one periodic wait
+ * is allowed on a timer at a time.
+ */
+inline void wait_every(steady_timer &t, steady_timer::duration period,
+                       callback<result<void>> &&cb) noexcept {
+  auto &b = t.base();
+  Expects(!b.tick_cb_ && period > steady_timer::duration::zero());
+  b.tick_cb_ = forward<callback<result<void>>>(cb);
+  b.period_ = period;
+  b.next_tick_ = steady_timer::clock::now();
+#ifdef IORING_TIMEOUT_MULTISHOT
+  b.multishot_ = true;
+#endif
+  auto ret = timer_tick_impl::arm(t.context(), b);
+  if (ret.has_error())
+    timer_tick_impl::finish(b, ret.error());
+}
+
+} // namespace async
+
+/*! @} */
+
+} // namespace ark
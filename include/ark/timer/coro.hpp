@@ -0,0 +1,53 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/coroutine/awaitable_op.hpp>
+#include <ark/timer/async.hpp>
+#include <ark/timer/steady_timer.hpp>
+
+namespace ark {
+
+/*! \addtogroup timer
+ *  @{
+ */
+
+namespace coro {
+
+/*! \cond HIDDEN_CLASSES */
+
+struct timer_wait_awaitable : public awaitable_op<result<void>> {
+  steady_timer &t_;
+
+  timer_wait_awaitable(steady_timer &t) noexcept : t_(t) {}
+
+  void invoke(callback<result<void>> &&cb) noexcept override {
+    async::wait(t_, forward<callback<result<void>>>(cb));
+  }
+};
+
+/*! \endcond */
+
+/*!
+ * \brief wait until the expiry of the timer
+ *
+ * returns an Awaitable which yields an result<void> when co_awaited, with
+ * ECANCELED if \ref ::ark::steady_timer::cancel was called before expiry.
+ *
+ * for periodic ticks, move the expiry forward before each wait
+ *
+ * \code
+ * for (;;) {
+ *   t.expires_at(t.expiry() + 1s);
+ *   CoTryX(co_await coro::wait(t));
+ *   ...
+ * }
+ * \endcode
+ */
+inline auto wait(steady_timer &t) noexcept { return timer_wait_awaitable(t); }
+
+} // namespace coro
+
+/*! @} */
+
+} // namespace ark
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async.hpp>
+
+namespace ark {
+
+/*! \addtogroup timer
+ *  @{
+ */
+
+/*!
+ * \brief a timer io object on the monotonic clock
+ *
+ * Unlike timerfd(2), no fd is opened for a timer. The waits are io operations
+ * of the bound \ref ::ark::async_context, on the native timeouts of the ring,
+ * so that a timer costs nothing but some memory until waited on.
+ *
+ * The timer must outlive the waits on it. Just like other io objects, it is
+ * not thread safe, async and coro waits should be started from the thread
+ * running the bound context (or before it runs).
+ */
+class steady_timer : public with_async_context {
+public:
+  using clock = chrono::steady_clock;
+  using time_point = clock::time_point;
+  using duration = clock::duration;
+
+  /*! \cond HIDDEN_CLASSES */
+
+  struct base_type {
+    time_point expiry_{};
+    // tokens of the timeouts in flight
+    vector<async_context::token_t> pending_;
+
+    // of the periodic wait, if any
+    callback<result<void>> tick_cb_;
+    duration period_{};
+    time_point next_tick_{};
+    bool multishot_{false};
+    async_context::token_t tick_tok_{};
+    clinux::__kernel_timespec tick_ts_{};
+
+    void untrack(async_context::token_t tok) noexcept {
+      pending_.erase(remove(pending_.begin(), pending_.end(), tok),
+                     pending_.end());
+    }
+  };
+
+  /*! \endcond */
+
+private:
+  unique_ptr<base_type> base_;
+
+  steady_timer() noexcept : base_(make_unique<base_type>()) {}
+
+  static result<steady_timer> __create(async_context *ctx) noexcept {
+    steady_timer ret;
+    ret.set_async_context(ctx);
+    return move(ret);
+  }
+
+public:
+  /*!
+   * \brief constructs a timer, expired at the epoch of the clock
+   */
+  static result<steady_timer> create() noexcept { return __create(nullptr); }
+
+  /*!
+   * \brief constructs a timer, expired at the epoch of the clock, and bind it
+   * to the given \ref ::ark::async_context
+   */
+  static result<steady_timer> create(async_context &ctx) noexcept {
+    return __create(&ctx);
+  }
+
+  /*!
+   * \brief returns the time point the timer expires at
+   */
+  time_point expiry() const noexcept {
+    Expects(base_);
+    return base_->expiry_;
+  }
+
+  /*!
+   * \brief sets the time point the timer expires at
+   *
+   * waits already started are not affected
+   */
+  void expires_at(time_point tp) noexcept {
+    Expects(base_);
+    base_->expiry_ = tp;
+  }
+
+  /*!
+   * \brief same as expires_at(clock::now() + d)
+   */
+  void expires_after(duration d) noexcept { expires_at(clock::now() + d); }
+
+  /*!
+   * \brief cancel all the waits in flight
+   *
+   * returns instantly, their callbacks are invoked with ECANCELED, unless
+   * they expired in the meantime.
+   */
+  result<void> cancel() noexcept {
+    Expects(base_);
+    for (auto tok : exchange(base_->pending_, {})) {
+      OUTCOME_TRY(async_syscall::timeout_remove(context(), tok));
+    }
+    return success();
+  }
+
+  /*! \cond HIDDEN_CLASSES */
+
+  base_type &base() noexcept {
+    Expects(base_);
+    return *base_;
+  }
+
+  /*! \endcond */
+};
+
+/*! @} */
+
+} // namespace ark
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/timer/steady_timer.hpp>
+
+namespace ark {
+
+/*! \addtogroup timer
+ *  @{
+ */
+
+namespace sync {
+
+/*!
+ * \brief wait until the expiry of the timer
+ *
+ * blocks until the timer expired
+ */
+inline result<void> wait(steady_timer &t) noexcept {
+  this_thread::sleep_until(t.expiry());
+  return success();
+}
+
+} // namespace sync
+
+/*! @} */
+
+} // namespace ark
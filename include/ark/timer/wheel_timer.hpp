@@ -0,0 +1,85 @@
+#pragma once
+
+#include <ark/bindings.hpp>
+
+#include <ark/async.hpp>
+
+namespace ark {
+
+/*! \addtogroup timer
+ *  @{
+ */
+
+/*!
+ * \brief a coarse timer on the timer wheel of an async_context
+ *
+ * Meant for timeouts which are re-armed far more often than they expire, like
+ * those of idle connections. Arming, re-arming and cancelling are O(1), never
+ * allocate and never enter the kernel, as the wheel of the context is driven
+ * by a single ring timeout per tick (see \ref
+ * ::ark::async_context_options::timer_tick) while any of its timers is armed.
+ * A timer expires at most a tick later than asked for.
+ *
+ * Unlike \ref ::ark::steady_timer, the callback is given once on creation, and
+ * invoked on each expiration. Not thread safe, the timer must only be used
+ * from the thread running the bound context (or before it runs), and must not
+ * outlive the context.
+ */
+class wheel_timer : public with_async_context {
+public:
+  using duration = chrono::steady_clock::duration;
+
+private:
+  // kept apart, as the wheel links to it
+  unique_ptr<async_context::timer_entry> e_;
+
+  wheel_timer(callback<void> &&cb) noexcept
+      : e_(make_unique<async_context::timer_entry>(
+            forward<callback<void>>(cb))) {}
+
+  static result<wheel_timer> __create(async_context *ctx,
+                                      callback<void> &&cb) noexcept {
+    wheel_timer ret{forward<callback<void>>(cb)};
+    ret.set_async_context(ctx);
+    return move(ret);
+  }
+
+public:
+  /*!
+   * \brief constructs a disarmed timer bound to the given \ref
+   * ::ark::async_context, cb is invoked on the thread running it on each
+   * expiration
+   */
+  static result<wheel_timer> create(async_context &ctx,
+                                    callback<void> &&cb) noexcept {
+    return __create(&ctx, forward<callback<void>>(cb));
+  }
+
+  /*!
+   * \brief arms the timer to expire after d, re-arming it if already armed
+   */
+  void expires_after(duration d) noexcept {
+    Expects(e_);
+    context().arm_timer(*e_, d);
+  }
+
+  /*!
+   * \brief disarms the timer, if armed
+   */
+  void cancel() noexcept {
+    Expects(e_);
+    context().cancel_timer(*e_);
+  }
+
+  /*!
+   * \brief returns true if the timer is armed and has not expired yet
+   */
+  bool armed() const noexcept {
+    Expects(e_);
+    return e_->armed();
+  }
+};
+
+/*! @} */
+
+} // namespace ark
@@ -0,0 +1,69 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <ark/async/io_uring/slot_table.hpp>
+
+using namespace ark;
+
+using table_t = io_uring_async::slot_table<unique_function<int()>>;
+
+TEST(async_slot_table, emplace_find_erase) {
+  table_t t;
+  auto tok = t.emplace([]() { return 42; });
+  EXPECT_NE(tok, table_t::null_token);
+  EXPECT_EQ(t.size(), 1u);
+
+  auto p = t.find(tok);
+  ASSERT_TRUE(p != nullptr);
+  EXPECT_EQ((*p)(), 42);
+
+  EXPECT_TRUE(t.erase(tok));
+  EXPECT_EQ(t.size(), 0u);
+  EXPECT_TRUE(t.find(tok) == nullptr);
+  EXPECT_FALSE(t.erase(tok));
+}
+
+TEST(async_slot_table, stale_token) {
+  table_t t;
+  auto tok1 = t.emplace([]() { return 1; });
+  EXPECT_TRUE(t.erase(tok1));
+
+  // the released slot gets reused, but under another generation
+  auto tok2 = t.emplace([]() { return 2; });
+  EXPECT_NE(tok1, tok2);
+  EXPECT_TRUE(t.find(tok1) == nullptr);
+  EXPECT_FALSE(t.erase(tok1));
+
+  auto p = t.find(tok2);
+  ASSERT_TRUE(p != nullptr);
+  EXPECT_EQ((*p)(), 2);
+}
+
+TEST(async_slot_table, null_and_garbage_token) {
+  table_t t;
+  t.reserve(16);
+  EXPECT_TRUE(t.find(table_t::null_token) == nullptr);
+  EXPECT_TRUE(t.find(~table_t::token_t{0}) == nullptr);
+}
+
+TEST(async_slot_table, stable_across_growth) {
+  table_t t;
+  auto first = t.emplace([]() { return -1; });
+  auto p_first = t.find(first);
+
+  std::vector<table_t::token_t> toks;
+  for (int i = 0; i < 10000; i++)
+    toks.push_back(t.emplace([i]() { return i; }));
+  EXPECT_EQ(t.size(), 10001u);
+
+  EXPECT_EQ(t.find(first), p_first);
+  for (int i = 0; i < 10000; i++) {
+    auto p = t.find(toks[i]);
+    ASSERT_TRUE(p != nullptr);
+    EXPECT_EQ((*p)(), i);
+  }
+  for (auto tok : toks)
+    EXPECT_TRUE(t.erase(tok));
+  EXPECT_EQ(t.size(), 1u);
+}
@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <ark/async/io_uring/timer_wheel.hpp>
+
+using namespace ark;
+
+using wheel_t = io_uring_async::timer_wheel;
+
+TEST(async_timer_wheel, expires_on_tick) {
+  wheel_t w;
+  std::vector<uint64_t> fired;
+  wheel_t::entry e{[&]() { fired.push_back(w.current()); }};
+
+  w.arm(e, 3);
+  EXPECT_TRUE(e.armed());
+  EXPECT_EQ(w.size(), 1u);
+
+  w.advance(2);
+  EXPECT_TRUE(fired.empty());
+  w.advance(3);
+  ASSERT_EQ(fired.size(), 1u);
+  EXPECT_EQ(fired[0], 3u);
+  EXPECT_FALSE(e.armed());
+  EXPECT_TRUE(w.empty());
+}
+
+TEST(async_timer_wheel, rearm_and_cancel) {
+  wheel_t w;
+  int fired = 0;
+  wheel_t::entry e{[&]() { fired++; }};
+
+  w.arm(e, 5);
+  w.advance(3);
+  // pushed back, relative to the next tick to be processed
+  w.arm(e, 5);
+  EXPECT_EQ(w.size(), 1u);
+  w.advance(5);
+  EXPECT_EQ(fired, 0);
+  w.advance(9);
+  EXPECT_EQ(fired, 1);
+
+  w.arm(e, 1);
+  e.cancel();
+  EXPECT_TRUE(w.empty());
+  w.advance(20);
+  EXPECT_EQ(fired, 1);
+}
+
+TEST(async_timer_wheel, cascades_from_upper_levels) {
+  wheel_t w;
+  std::vector<uint64_t> ticks{1, 255, 256, 257, 1000, 16383, 16384, 70000,
+                              1u << 20};
+  std::vector<std::unique_ptr<wheel_t::entry>> entries;
+  std::vector<uint64_t> fired;
+  for (auto t : ticks) {
+    entries.push_back(std::make_unique<wheel_t::entry>(
+        [&]() { fired.push_back(w.current()); }));
+    w.arm(*entries.back(), t);
+  }
+
+  w.advance(1u << 20);
+  EXPECT_EQ(fired, ticks);
+  EXPECT_TRUE(w.empty());
+}
+
+TEST(async_timer_wheel, rearm_from_callback) {
+  wheel_t w;
+  int fired = 0;
+  wheel_t::entry e;
+  e.set_callback([&]() {
+    if (++fired < 3)
+      w.arm(e, 1);
+  });
+
+  w.arm(e, 1);
+  w.advance(10);
+  EXPECT_EQ(fired, 3);
+  EXPECT_TRUE(w.empty());
+}
+
+TEST(async_timer_wheel, destroyed_entry_is_cancelled) {
+  wheel_t w;
+  {
+    wheel_t::entry e{[]() { ADD_FAILURE(); }};
+    w.arm(e, 2);
+    EXPECT_EQ(w.size(), 1u);
+  }
+  EXPECT_TRUE(w.empty());
+  w.advance(5);
+}
@@ -0,0 +1,79 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <ark/misc/work_stealing_deque.hpp>
+
+using namespace ark;
+
+TEST(misc_work_stealing_deque, owner_lifo_thief_fifo) {
+  work_stealing_deque<int, 8> d;
+  EXPECT_TRUE(d.empty());
+  for (int i = 1; i <= 4; i++)
+    EXPECT_TRUE(d.push(i));
+  EXPECT_FALSE(d.empty());
+
+  EXPECT_EQ(d.pop(), 4);
+  EXPECT_EQ(d.steal(), 1);
+  EXPECT_EQ(d.pop(), 3);
+  EXPECT_EQ(d.steal(), 2);
+  EXPECT_EQ(d.pop(), 0);
+  EXPECT_EQ(d.steal(), 0);
+  EXPECT_TRUE(d.empty());
+}
+
+TEST(misc_work_stealing_deque, bounded) {
+  work_stealing_deque<int, 4> d;
+  for (int i = 1; i <= 4; i++)
+    EXPECT_TRUE(d.push(i));
+  EXPECT_FALSE(d.push(5));
+  EXPECT_EQ(d.steal(), 1);
+  EXPECT_TRUE(d.push(5));
+}
+
+TEST(misc_work_stealing_deque, concurrent_steal) {
+  static const int n = 100000;
+  work_stealing_deque<int, 1024> d;
+  std::atomic<bool> done{false};
+  std::atomic<long> sum{0};
+  std::atomic<int> count{0};
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < 3; i++) {
+    thieves.emplace_back([&]() {
+      while (!done.load()) {
+        int v = d.steal();
+        if (v != 0) {
+          sum += v;
+          count++;
+        }
+      }
+    });
+  }
+
+  for (int i = 1; i <= n;) {
+    if (d.push(i)) {
+      i++;
+      continue;
+    }
+    int v = d.pop();
+    if (v != 0) {
+      sum += v;
+      count++;
+    }
+  }
+  for (int v = d.pop(); v != 0; v = d.pop()) {
+    sum += v;
+    count++;
+  }
+  while (count.load() != n)
+    std::this_thread::yield();
+  done = true;
+  for (auto &t : thieves)
+    t.join();
+
+  EXPECT_EQ(count.load(), n);
+  EXPECT_EQ(sum.load(), static_cast<long>(n) * (n + 1) / 2);
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include <ark.hpp>
+#include <ark/misc/test_r.hpp>
+
+using namespace ark;
+namespace tcp = net::tcp;
+
+// a cancelled op must report its error once, and nothing after it
+TEST_R(net_tcp, cancel_pending_accept) {
+  async_context ctx;
+  OUTCOME_TRY(ctx.init());
+
+  net::inet_address ep;
+  OUTCOME_TRY(ep.host("127.0.0.1"));
+  ep.port(18093);
+  OUTCOME_TRY(ac, tcp::acceptor::create(ctx));
+  OUTCOME_TRY(tcp::bind(ac, ep));
+  OUTCOME_TRY(tcp::listen(ac));
+
+  int calls = 0;
+  result<tcp::socket> got = as_ec(EINVAL);
+  tcp::async::accept(ac, [&](result<tcp::socket> ret) {
+    calls++;
+    got = move(ret);
+    ctx.exit();
+  });
+  OUTCOME_TRY(async::cancel(ac));
+  OUTCOME_TRY(ctx.run());
+
+  EXPECT_EQ(calls, 1);
+  EXPECT_TRUE(got.has_error());
+  if (got.has_error())
+    EXPECT_EQ(got.error().value(), ECANCELED);
+  return success();
+}
+
+TEST_R(net_tcp, cancel_pending_connect) {
+  async_context ctx;
+  OUTCOME_TRY(ctx.init());
+
+  // TEST-NET-1, either never answers or is unreachable
+  net::inet_address ep;
+  OUTCOME_TRY(ep.host("192.0.2.1"));
+  ep.port(18094);
+  OUTCOME_TRY(s, tcp::socket::create(ctx));
+
+  int calls = 0;
+  result<void> got = success();
+  tcp::async::connect(s, ep.to_address(), [&](result<void> ret) {
+    calls++;
+    got = move(ret);
+    ctx.exit();
+  });
+  OUTCOME_TRY(async::cancel(s));
+  OUTCOME_TRY(ctx.run());
+
+  EXPECT_EQ(calls, 1);
+  EXPECT_TRUE(got.has_error());
+  return success();
+}
+
+// the idle timeouts are armed and freed by the loop, whichever thread sets
+// them or closes the sockets
+TEST_R(net_tcp, close_timed_socket_off_loop) {
+  async_context_options opts;
+  opts.timer_tick = std::chrono::milliseconds(1);
+  async_context ctx;
+  OUTCOME_TRY(ctx.init(opts));
+
+  // expires once the loop runs
+  std::promise<void> running;
+  OUTCOME_TRY(t, wheel_timer::create(ctx, [&]() { running.set_value(); }));
+  t.expires_after(std::chrono::milliseconds(1));
+
+  result<void> loop_ret = success();
+  std::thread loop([&]() { loop_ret = ctx.run(); });
+  running.get_future().wait();
+
+  for (int i = 0; i < 100; i++) {
+    auto s = tcp::socket::create(ctx);
+    EXPECT_FALSE(s.has_error());
+    if (s.has_error())
+      break;
+    s.value().set_idle_timeout(std::chrono::milliseconds(1 + i % 3));
+    if (i % 2 == 0)
+      EXPECT_FALSE(s.value().close().has_error());
+  }
+  // runs after the frees dispatched above
+  EXPECT_FALSE(ctx.dispatch([&]() { ctx.exit(); }).has_error());
+  loop.join();
+
+  EXPECT_FALSE(loop_ret.has_error());
+  return success();
+}
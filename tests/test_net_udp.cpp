@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <ark/misc/test_r.hpp>
+#include <ark/net.hpp>
+
+using namespace ark;
+namespace udp = net::udp;
+
+TEST_R(net_udp, sync_send_receive) {
+  net::inet_address ep;
+  OUTCOME_TRY(ep.host("127.0.0.1"));
+  ep.port(18090);
+  OUTCOME_TRY(rx, udp::socket::create());
+  OUTCOME_TRY(udp::bind(rx, ep));
+  OUTCOME_TRY(tx, udp::socket::create());
+
+  std::string msg = "hello";
+  OUTCOME_TRY(sent, udp::sync::send_to(tx, buffer(msg), ep.to_address()));
+  EXPECT_EQ(sent, msg.size());
+
+  char buf[64];
+  net::address from;
+  OUTCOME_TRY(info, udp::sync::receive_from(rx, buffer(buf), from));
+  EXPECT_EQ(std::string(buf, info.size), msg);
+  EXPECT_FALSE(info.truncated);
+  EXPECT_EQ(from.sa_family(), AF_INET);
+
+  return success();
+}
+
+TEST_R(net_udp, sync_segmented_send) {
+  net::inet_address ep;
+  OUTCOME_TRY(ep.host("127.0.0.1"));
+  ep.port(18091);
+  OUTCOME_TRY(rx, udp::socket::create());
+  OUTCOME_TRY(udp::bind(rx, ep));
+  OUTCOME_TRY(tx, udp::socket::create());
+
+  // without GRO on the receiving side, each segment arrives as a datagram
+  std::string msg(10, 'x');
+  auto sent = udp::sync::send_to(tx, buffer(msg), ep.to_address(), 4);
+  if (sent.has_error()) // UDP_SEGMENT unsupported by the kernel
+    return success();
+  EXPECT_EQ(sent.value(), msg.size());
+
+  char buf[64];
+  net::address from;
+  for (size_t expected : {4, 4, 2}) {
+    OUTCOME_TRY(info, udp::sync::receive_from(rx, buffer(buf), from));
+    EXPECT_EQ(info.size, expected);
+  }
+
+  return success();
+}
+
+TEST_R(net_udp, sync_batch) {
+  net::inet_address ep;
+  OUTCOME_TRY(ep.host("127.0.0.1"));
+  ep.port(18092);
+  OUTCOME_TRY(rx, udp::socket::create());
+  OUTCOME_TRY(udp::bind(rx, ep));
+  OUTCOME_TRY(tx, udp::socket::create());
+
+  std::vector<std::string> msgs;
+  std::vector<udp::sync::send_slot> out;
+  for (int i = 0; i < 100; i++)
+    msgs.push_back(std::to_string(i));
+  for (auto &m : msgs)
+    out.push_back({buffer(m), ep.to_address()});
+  OUTCOME_TRY(sent, udp::sync::send_batch(tx, out));
+  EXPECT_EQ(sent, msgs.size());
+
+  std::vector<std::array<char, 16>> bufs(msgs.size());
+  std::vector<udp::sync::receive_slot> in;
+  for (auto &b : bufs)
+    in.push_back({buffer(b.data(), b.size())});
+  size_t got = 0;
+  while (got < msgs.size()) {
+    OUTCOME_TRY(n, udp::sync::receive_batch(
+                       rx, span<udp::sync::receive_slot>(in).subspan(got)));
+    got += n;
+  }
+  for (size_t i = 0; i < msgs.size(); i++)
+    EXPECT_EQ(std::string(bufs[i].data(), in[i].info.size), msgs[i]);
+
+  return success();
+}